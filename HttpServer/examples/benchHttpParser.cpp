@@ -0,0 +1,138 @@
+// 请求解析微基准：对比基于std::regex的旧解析方式与手写单次扫描解析
+#include <iostream>
+#include <chrono>
+#include <map>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "http/HttpRequest.h"
+
+using namespace tinyHttp;
+
+// 典型浏览器请求的请求头组合，包含较长的Cookie和User-Agent
+static const std::vector<std::string> kHeaderLines = {
+    "Host: api.example.com",
+    "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/120.0 Safari/537.36",
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/avif,image/webp,*/*;q=0.8",
+    "Accept-Language: zh-CN,zh;q=0.9,en;q=0.8",
+    "Accept-Encoding: gzip, deflate, br",
+    "Connection: keep-alive",
+    "Cookie: sessionId=0123456789abcdef0123456789abcdef; theme=dark; _ga=GA1.2.1234567890.1700000000; lang=zh-CN",
+    "Referer: https://www.example.com/search?q=tinyhttp",
+    "Cache-Control: max-age=0",
+    "Content-Type: application/json",
+    "Content-Length: 0",
+};
+static const std::string kMethod = "POST";
+static const std::string kQuery = "page=3&size=20&sort=createdAt&order=desc&keyword=http";
+
+// 旧实现：每次调用都构造正则表达式与方法查找表
+struct LegacyRequest
+{
+    HttpRequest::Method method_ = HttpRequest::kInvalid;
+    std::unordered_map<std::string, std::string> queryParameters_;
+    std::map<std::string, std::string> headers_;
+    uint64_t contentLength_ = 0;
+
+    bool setMethod(const char* start, const char* end)
+    {
+        const std::string method(start, end);
+        std::unordered_map<std::string, HttpRequest::Method> parseMethods
+        {
+            {"GET", HttpRequest::kGet}, {"POST", HttpRequest::kPost}, {"DELETE", HttpRequest::kDelete},
+            {"PUT", HttpRequest::kPut}, {"OPTIONS", HttpRequest::kOptions}, {"HEAD", HttpRequest::kHead}
+        };
+        if (const auto it = parseMethods.find(method); it != parseMethods.end())
+        {
+            method_ = it->second;
+            return true;
+        }
+        return false;
+    }
+
+    void setQueryParameters(const char* start, const char* end)
+    {
+        std::string qs(start, end);
+        std::regex re(R"(([^&=]+)=([^&]*))");
+        const auto itBegin = std::sregex_iterator(qs.begin(), qs.end(), re);
+        const auto itEnd = std::sregex_iterator();
+        for (auto it = itBegin; it != itEnd; ++it) {
+            const std::smatch& m = *it;
+            queryParameters_[m[1]] = m[2];
+        }
+    }
+
+    void addHeader(const char* start, const char* end)
+    {
+        std::string qs(start, end);
+        std::regex re(R"(([^&:=]+):\s*([^&]*))");
+        std::smatch m;
+        std::regex_search(qs, m, re);
+        headers_[m[1]] = m[2];
+        if (m[1] == "Content-Length")
+        {
+            contentLength_ = std::stoull(m[2]);
+        }
+    }
+};
+
+template <typename Request>
+static void parseOnce(Request& req)
+{
+    req.setMethod(kMethod.data(), kMethod.data() + kMethod.size());
+    req.setQueryParameters(kQuery.data(), kQuery.data() + kQuery.size());
+    for (const auto& line : kHeaderLines)
+    {
+        req.addHeader(line.data(), line.data() + line.size());
+    }
+}
+
+// 返回每次解析的平均耗时(ns)
+template <typename Request>
+static double benchmark(const char* name, int iterations)
+{
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        Request req;
+        parseOnce(req);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double perOp = ns / iterations;
+    std::cout << "[" << name << "] " << iterations << " requests, avg " << perOp << " ns/request" << std::endl;
+    return perOp;
+}
+
+int main()
+{
+    const int iterations = 2000;
+
+    std::cout << "=== Request Parser Benchmark ===" << std::endl;
+    std::cout << "Headers/request: " << kHeaderLines.size() << ", query: " << kQuery << std::endl;
+
+    // 预热并校验两种实现结果一致
+    LegacyRequest legacy;
+    HttpRequest current;
+    parseOnce(legacy);
+    parseOnce(current);
+    for (const auto& [field, value] : legacy.headers_)
+    {
+        if (current.getHeader(field) != value)
+        {
+            std::cerr << "[ERROR] Header mismatch: " << field << std::endl;
+            return 1;
+        }
+    }
+
+    double legacyNs = benchmark<LegacyRequest>("Regex", iterations);
+    double currentNs = benchmark<HttpRequest>("Tokenizer", iterations);
+
+    std::cout << "-------------------------------------" << std::endl;
+    if (currentNs > 0)
+    {
+        std::cout << "Speedup (Regex/Tokenizer): " << std::fixed << legacyNs / currentNs << "x" << std::endl;
+    }
+    return 0;
+}
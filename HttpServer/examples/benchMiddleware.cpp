@@ -0,0 +1,154 @@
+// 中间件链调用开销基准：对比通过虚函数逐个调用的动态MiddlewareChain与编译期组合的StaticMiddlewareChain
+#include <iostream>
+#include <chrono>
+#include <memory>
+#include <string>
+#include "middleware/MiddlewareChain.h"
+#include "middleware/StaticMiddlewareChain.h"
+
+using namespace tinyHttp;
+
+// 典型生产栈中各中间件的轻量替身，只保留各自在请求路径上的判断逻辑
+class LoggingMiddleware : public Middleware
+{
+public:
+    bool before(HttpRequest& request, HttpResponse&) override
+    {
+        bytes_ += request.path().size();
+        return true;
+    }
+
+    void after(const HttpRequest&, HttpResponse& response) override
+    {
+        statusSum_ += response.getStatusCode();
+    }
+
+    uint64_t bytes_ = 0;
+    uint64_t statusSum_ = 0;
+};
+
+class AuthMiddleware : public Middleware
+{
+public:
+    bool before(HttpRequest& request, HttpResponse& response) override
+    {
+        if (request.getHeader("Authorization").empty())
+        {
+            response.setStatusCode(HttpResponse::k401Unauthorized);
+            return false;
+        }
+        return true;
+    }
+
+    void after(const HttpRequest&, HttpResponse&) override {}
+};
+
+class CorsMiddleware : public Middleware
+{
+public:
+    bool before(HttpRequest&, HttpResponse&) override { return true; }
+
+    void after(const HttpRequest& request, HttpResponse& response) override
+    {
+        if (!request.getHeader("Origin").empty())
+        {
+            response.addHeader("Access-Control-Allow-Origin", "*");
+        }
+    }
+};
+
+class CompressionProbeMiddleware : public Middleware
+{
+public:
+    bool before(HttpRequest&, HttpResponse&) override { return true; }
+
+    void after(const HttpRequest& request, HttpResponse&) override
+    {
+        accepted_ += request.acceptsEncoding("gzip");
+    }
+
+    uint64_t accepted_ = 0;
+};
+
+using ProductionStack = StaticMiddlewareChain<LoggingMiddleware, AuthMiddleware, CorsMiddleware, CompressionProbeMiddleware>;
+
+static HttpRequest makeRequest()
+{
+    HttpRequest req;
+    req.setMethod(HttpRequest::kGet);
+    req.setPath("/api/items");
+    const std::string headers[] = {"Authorization: Bearer token", "Origin: https://example.com", "Accept-Encoding: gzip"};
+    for (const auto& header : headers)
+    {
+        req.addHeader(header.data(), header.data() + header.size());
+    }
+    return req;
+}
+
+// 返回每个请求经过整条中间件链的平均耗时(ns)
+template <typename Run>
+static double benchmark(const char* name, int iterations, Run&& run)
+{
+    HttpRequest req = makeRequest();
+    HttpResponse resp;
+    int ok = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        ok += run(req, resp);
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double perOp = ns / iterations;
+    std::cout << "[" << name << "] " << ok << "/" << iterations << " requests, avg " << perOp << " ns/request" << std::endl;
+    return perOp;
+}
+
+int main()
+{
+    const int iterations = 5000000;
+
+    std::cout << "=== Middleware Chain Benchmark ===" << std::endl;
+
+    MiddlewareChain dynamicChain;
+    dynamicChain.registerMiddleware(std::make_shared<LoggingMiddleware>());
+    dynamicChain.registerMiddleware(std::make_shared<AuthMiddleware>());
+    dynamicChain.registerMiddleware(std::make_shared<CorsMiddleware>());
+    dynamicChain.registerMiddleware(std::make_shared<CompressionProbeMiddleware>());
+    dynamicChain.compile();
+
+    double dynamicNs = benchmark("Dynamic", iterations, [&](HttpRequest& req, HttpResponse& resp) {
+        const MiddlewareChain::Pipeline& pipeline = dynamicChain.select(req);
+        size_t passed = 0;
+        const bool reached = MiddlewareChain::handleRequest(pipeline, req, resp, &passed);
+        MiddlewareChain::handleResponse(pipeline, passed, req, resp);
+        return reached;
+    });
+
+    ProductionStack staticChain;
+    double staticNs = benchmark("Static", iterations, [&](HttpRequest& req, HttpResponse& resp) {
+        bool reached = false;
+        staticChain.handle(req, resp, [&](HttpRequest&, HttpResponse&) { reached = true; });
+        return reached;
+    });
+
+    // 静态链作为一个整体注册进动态链，与插件式中间件共存
+    MiddlewareChain mixedChain;
+    mixedChain.registerMiddleware(std::make_shared<ProductionStack>());
+    mixedChain.compile();
+    double mixedNs = benchmark("Static in Dynamic", iterations, [&](HttpRequest& req, HttpResponse& resp) {
+        const MiddlewareChain::Pipeline& pipeline = mixedChain.select(req);
+        size_t passed = 0;
+        const bool reached = MiddlewareChain::handleRequest(pipeline, req, resp, &passed);
+        MiddlewareChain::handleResponse(pipeline, passed, req, resp);
+        return reached;
+    });
+
+    std::cout << "-------------------------------------" << std::endl;
+    if (staticNs > 0)
+    {
+        std::cout << "Speedup (Dynamic/Static): " << std::fixed << dynamicNs / staticNs << "x" << std::endl;
+        std::cout << "Speedup (Dynamic/Static in Dynamic): " << std::fixed << dynamicNs / mixedNs << "x" << std::endl;
+    }
+    return 0;
+}
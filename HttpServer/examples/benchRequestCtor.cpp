@@ -0,0 +1,81 @@
+// HttpRequest构造开销基准：对比构造时注册std::function自检表的旧实现与switch分派的新实现
+#include <iostream>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include "http/HttpRequest.h"
+
+using namespace tinyHttp;
+
+// 旧实现：每个请求对象构造时都建立一张方法->自检函数的哈希表，lambda捕获this
+class LegacyRequest
+{
+public:
+    LegacyRequest()
+        : selfCheckFunc_({
+            {HttpRequest::kGet,    [this] { return checkGetLikeMethod(); }},
+            {HttpRequest::kPost,   [this] { return checkPostLikeMethod(); }},
+            {HttpRequest::kPut,    [this] { return checkPostLikeMethod(); }},
+            {HttpRequest::kDelete, [this] { return checkGetLikeMethod(); }}
+        })
+    {
+
+    }
+
+    void setMethod(HttpRequest::Method method) { method_ = method; }
+
+    bool selfCheck() const
+    {
+        auto it = selfCheckFunc_.find(method_);
+        if (it != selfCheckFunc_.end())
+        {
+            return it->second();
+        }
+        return true;
+    }
+
+private:
+    bool checkGetLikeMethod() const { return content_.empty(); }
+    bool checkPostLikeMethod() const { return !content_.empty(); }
+
+    std::unordered_map<HttpRequest::Method, std::function<bool()>> selfCheckFunc_;
+    HttpRequest::Method method_ = HttpRequest::kInvalid;
+    std::string content_;
+};
+
+// 返回每次构造+自检的平均耗时(ns)
+template <typename Request>
+static double benchmark(const char* name, int iterations)
+{
+    int ok = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        Request req;
+        req.setMethod(HttpRequest::kGet);
+        ok += req.selfCheck();
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+    double perOp = ns / iterations;
+    std::cout << "[" << name << "] " << ok << "/" << iterations << " requests, avg " << perOp << " ns/request" << std::endl;
+    return perOp;
+}
+
+int main()
+{
+    const int iterations = 1000000;
+
+    std::cout << "=== HttpRequest Construction Benchmark ===" << std::endl;
+
+    double legacyNs = benchmark<LegacyRequest>("FunctionMap", iterations);
+    double currentNs = benchmark<HttpRequest>("Switch", iterations);
+
+    std::cout << "-------------------------------------" << std::endl;
+    if (currentNs > 0)
+    {
+        std::cout << "Speedup (FunctionMap/Switch): " << std::fixed << legacyNs / currentNs << "x" << std::endl;
+    }
+    return 0;
+}
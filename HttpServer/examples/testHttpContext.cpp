@@ -6,6 +6,8 @@
 #include <muduo/base/Timestamp.h>
 #include <muduo/net/Buffer.h>
 
+using namespace tinyHttp;
+
 void testGet(HttpContext& context)
 {
     // 创建 Buffer 并填充一个简单的 HTTP 请求报文
@@ -29,6 +31,9 @@ void testGet(HttpContext& context)
     // 验证请求行解析结果
     assert(request.method() == HttpRequest::kGet);
     assert(request.path() == "/index.html");
+    assert(request.getQueryParameters("debug") == "1");
+    assert(request.getQueryParameters("judge") == "2");
+    assert(request.getVersion() == "HTTP/1.1");
     assert(request.getHeader("Host") == "www.example.com");
     assert(request.getHeader("User-Agent") == "TestAgent/1.0");
     assert(request.getHeader("Accept") == "*/*");
@@ -72,6 +77,339 @@ void testPost(HttpContext& context)
     std::cout << "HttpContext POST test passed!" << std::endl;
 }
 
+// 测试请求分多个TCP分段到达：请求行、请求头、请求体被拆开，且CRLF被截断在两个分段之间
+void testSegmented(HttpContext& context)
+{
+    muduo::net::Buffer buffer;
+    const std::string segments[] = {
+        "POST /upload HT",
+        "TP/1.1\r",
+        "\nHost: www.example.com\r\nContent-Type: application/json\r\n",
+        "content-length: 13\r\n\r",
+        "\n{\"a\":",
+        "\"12345\"}",
+    };
+
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+    for (const auto& segment : segments)
+    {
+        assert(!context.parseComplete());
+        buffer.append(segment);
+        bool result = context.parseRequest(&buffer, receiveTime);
+        assert(result == true);
+    }
+    assert(context.parseComplete());
+    assert(buffer.readableBytes() == 0);
+
+    const HttpRequest& request = context.request();
+    assert(request.method() == HttpRequest::kPost);
+    assert(request.path() == "/upload");
+    assert(request.getHeader("Host") == "www.example.com");
+    assert(request.getBody() == "{\"a\":\"12345\"}");
+    // 请求头字段名大小写不敏感
+    assert(request.contentLength() == 13);
+    assert(request.getHeader("Content-Length") == "13");
+    assert(request.getHeader("HOST") == "www.example.com");
+
+    std::cout << "HttpContext segmented test passed!" << std::endl;
+}
+
+// 测试大量请求头与超长Cookie，按小片段逐步到达
+void testManyHeaders(HttpContext& context)
+{
+    std::string httpRequest = "GET /assets/app.js HTTP/1.1\r\n";
+    for (int i = 0; i < 40; ++i)
+    {
+        httpRequest += "X-Custom-" + std::to_string(i) + ": value:" + std::to_string(i) + "\r\n";
+    }
+    const std::string cookie = "sessionId=" + std::string(4096, 'a') + "; theme=dark";
+    httpRequest += "Cookie: " + cookie + "\r\n\r\n";
+
+    muduo::net::Buffer buffer;
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+    for (size_t pos = 0; pos < httpRequest.size(); pos += 7)
+    {
+        buffer.append(httpRequest.substr(pos, 7));
+        bool result = context.parseRequest(&buffer, receiveTime);
+        assert(result == true);
+    }
+    assert(context.parseComplete());
+
+    const HttpRequest& request = context.request();
+    assert(request.getHeader("X-Custom-0") == "value:0");
+    assert(request.getHeader("X-Custom-39") == "value:39");
+    assert(request.getHeader("Cookie") == cookie);
+
+    std::cout << "HttpContext many headers test passed!" << std::endl;
+}
+
+// 测试长连接上复用同一个HttpContext，前一个请求的字段不会残留到下一个请求中
+void testKeepAlive(HttpContext& context)
+{
+    muduo::net::Buffer buffer;
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+
+    buffer.append("POST /first?token=abc HTTP/1.1\r\n"
+                  "Content-Type: application/json\r\n"
+                  "Content-Length: 2\r\n"
+                  "\r\n"
+                  "{}");
+    bool result = context.parseRequest(&buffer, receiveTime);
+    assert(result == true);
+    assert(context.parseComplete());
+    assert(context.request().getQueryParameters("token") == "abc");
+    context.reset();
+
+    buffer.append("GET /second HTTP/1.0\r\n"
+                  "Host: www.example.com\r\n"
+                  "\r\n");
+    result = context.parseRequest(&buffer, receiveTime);
+    assert(result == true);
+    assert(context.parseComplete());
+
+    const HttpRequest& request = context.request();
+    assert(request.method() == HttpRequest::kGet);
+    assert(request.path() == "/second");
+    assert(request.getVersion() == "HTTP/1.0");
+    assert(request.getQueryParameters("token").empty());
+    assert(request.getHeader("Content-Type").empty());
+    assert(request.getBody().empty());
+    assert(request.contentLength() == 0);
+
+    std::cout << "HttpContext keep-alive test passed!" << std::endl;
+}
+
+// 测试流水线请求：一个分段中包含多个完整请求和半个请求
+void testPipelined(HttpContext& context)
+{
+    muduo::net::Buffer buffer;
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+    buffer.append("GET /a HTTP/1.1\r\nHost: x\r\n\r\n"
+                  "GET /b HTTP/1.1\r\nHost: x\r\n\r\n"
+                  "GET /c HTTP/1.1\r\nHo");
+
+    std::string paths;
+    while (context.parseRequest(&buffer, receiveTime) && context.parseComplete())
+    {
+        paths += std::string(context.request().path());
+        context.reset();
+    }
+    assert(paths == "/a/b");
+    assert(!context.parseComplete());
+
+    buffer.append("st: x\r\n\r\n");
+    bool result = context.parseRequest(&buffer, receiveTime);
+    assert(result == true);
+    assert(context.parseComplete());
+    assert(context.request().path() == "/c");
+    assert(buffer.readableBytes() == 0);
+
+    std::cout << "HttpContext pipelined test passed!" << std::endl;
+}
+
+// 测试chunked编码的请求体：块大小、块数据、trailer分多次到达
+void testChunked(HttpContext& context)
+{
+    muduo::net::Buffer buffer;
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+    const std::string httpRequest =
+        "POST /stream HTTP/1.1\r\n"
+        "Content-Type: application/json\r\n"
+        "Transfer-Encoding: chunked\r\n"
+        "\r\n"
+        "5;name=value\r\n{\"a\":\r\n"
+        "A\r\n\"12345678\"\r\n"
+        "1\r\n}\r\n"
+        "0\r\n"
+        "X-Checksum: 42\r\n"
+        "\r\n";
+    for (size_t pos = 0; pos < httpRequest.size(); pos += 3)
+    {
+        buffer.append(httpRequest.substr(pos, 3));
+        bool result = context.parseRequest(&buffer, receiveTime);
+        assert(result == true);
+    }
+    assert(context.parseComplete());
+
+    const HttpRequest& request = context.request();
+    assert(request.getBody() == "{\"a\":\"12345678\"}");
+    assert(request.contentLength() == request.getBody().size());
+    assert(request.getHeader("X-Checksum") == "42");
+
+    // 超过最大长度的块直接拒绝
+    HttpContext limited(8);
+    buffer.append("POST /stream HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n10\r\n");
+    bool result = limited.parseRequest(&buffer, receiveTime);
+    assert(result == false);
+
+    // trailer中的分帧字段与Host被丢弃，不影响请求体长度
+    context.reset();
+    buffer.retrieveAll();
+    buffer.append("POST /stream HTTP/1.1\r\nHost: a\r\nContent-Type: application/json\r\n"
+                  "Transfer-Encoding: chunked\r\n\r\n"
+                  "2\r\n{}\r\n0\r\nContent-Length: 100\r\nHost: b\r\nTransfer-Encoding: gzip\r\nX-Checksum: 7\r\n\r\n");
+    result = context.parseRequest(&buffer, receiveTime);
+    assert(result == true);
+    assert(context.parseComplete());
+    assert(context.request().contentLength() == 2);
+    assert(context.request().getHeader("Host") == "a");
+    assert(context.request().getHeader("Transfer-Encoding") == "chunked");
+    assert(context.request().getHeader("X-Checksum") == "7");
+
+    // trailer行数不限但总长度受限
+    context.reset();
+    buffer.append("POST /stream HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n");
+    result = true;
+    for (int i = 0; i < 10000 && result; ++i)
+    {
+        buffer.append("X-Trailer-" + std::to_string(i) + ": " + std::string(32, 'v') + "\r\n");
+        result = context.parseRequest(&buffer, receiveTime);
+    }
+    assert(result == false);
+
+    std::cout << "HttpContext chunked test passed!" << std::endl;
+}
+
+void testStreamingBody(HttpContext& context)
+{
+    muduo::net::Buffer buffer;
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+    std::string received;
+    size_t budget = 0; // sink每次最多消费的字节数，模拟下游处理较慢
+    HttpContext::ResumeCallback resume;
+    context.setHeadersCallback([&](HttpContext* ctx) {
+        if (ctx->request().path() == "/upload")
+        {
+            ctx->setBodySink([&](const HttpRequest&, const char* data, size_t len) {
+                const size_t n = std::min(len, budget);
+                received.append(data, n);
+                budget -= n;
+                return n;
+            }, 1024, [&](const HttpRequest&, HttpContext::ResumeCallback cb) { resume = std::move(cb); });
+        }
+    });
+
+    const std::string body(100, 'x');
+    buffer.append("POST /upload HTTP/1.1\r\nContent-Type: application/octet-stream\r\nContent-Length: 100\r\n\r\n");
+    buffer.append(body);
+    budget = 30;
+    bool result = context.parseRequest(&buffer, receiveTime);
+    assert(result == true);
+    assert(!context.parseComplete());
+    assert(context.bodyPaused());
+    assert(received.size() == 30);
+    assert(buffer.readableBytes() == 70); // 未消费的数据留在输入缓冲区
+    // 暂停后由连接把resume交给sink，这里模拟连接的做法：resume被调用时重新解析
+    assert(context.pauseCallback());
+    bool resumed = false;
+    context.pauseCallback()(context.request(), [&] { resumed = true; });
+    assert(!resumed);
+
+    budget = 100;
+    resume();
+    assert(resumed);
+    result = context.parseRequest(&buffer, receiveTime);
+    assert(result == true);
+    assert(context.parseComplete());
+    assert(!context.bodyPaused());
+    assert(received == body);
+    // 请求体没有缓存在请求中
+    assert(context.request().bodyStreamed());
+    assert(context.request().getBody().empty());
+
+    // 普通路径仍缓存请求体
+    context.reset();
+    buffer.append("POST /login HTTP/1.1\r\nContent-Type: application/json\r\nContent-Length: 2\r\n\r\n{}");
+    result = context.parseRequest(&buffer, receiveTime);
+    assert(result == true);
+    assert(context.parseComplete());
+    assert(!context.request().bodyStreamed());
+    assert(!context.pauseCallback());
+    assert(context.request().getBody() == "{}");
+
+    // 流式请求体按处理器自己的上限校验
+    context.reset();
+    buffer.append("POST /upload HTTP/1.1\r\nContent-Length: 4096\r\n\r\n");
+    result = context.parseRequest(&buffer, receiveTime);
+    assert(result == false);
+
+    std::cout << "HttpContext streaming body test passed!" << std::endl;
+}
+
+// 测试无法解析或相互冲突的Content-Length被拒绝，请求体不会被当作下一个请求解析
+void testInvalidContentLength(HttpContext& context)
+{
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+    const char* requests[] = {
+        "POST /a HTTP/1.1\r\nContent-Length: 12abc\r\n\r\nGET /b HTTP/1.1\r\n\r\n",
+        "POST /a HTTP/1.1\r\nContent-Length: \r\n\r\n",
+        "POST /a HTTP/1.1\r\nContent-Length: 0\r\nContent-Length: 20\r\n\r\nGET /b HTTP/1.1\r\n\r\n",
+    };
+    for (const char* httpRequest : requests)
+    {
+        muduo::net::Buffer buffer;
+        buffer.append(httpRequest);
+        bool result = context.parseRequest(&buffer, receiveTime);
+        assert(result == false);
+        context.reset();
+    }
+
+    // 重复但取值相同的Content-Length仍然接受
+    muduo::net::Buffer buffer;
+    buffer.append("POST /a HTTP/1.1\r\nContent-Type: application/json\r\nContent-Length: 2\r\nContent-Length: 2\r\n\r\n{}");
+    bool result = context.parseRequest(&buffer, receiveTime);
+    assert(result == true);
+    assert(context.parseComplete());
+    assert(context.request().getBody() == "{}");
+
+    std::cout << "HttpContext invalid Content-Length test passed!" << std::endl;
+}
+
+// 测试超长请求头：无论分多次到达还是一次完整到达都被拒绝
+void testHeadersTooLarge(HttpContext& context)
+{
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+    const std::string httpRequest =
+        "GET / HTTP/1.1\r\nX-Padding: " + std::string(128 * 1024, 'a') + "\r\n\r\n";
+
+    muduo::net::Buffer buffer;
+    buffer.append(httpRequest);
+    bool result = context.parseRequest(&buffer, receiveTime);
+    assert(result == false);
+
+    context.reset();
+    muduo::net::Buffer segmented;
+    result = true;
+    for (size_t pos = 0; pos < httpRequest.size() && result; pos += 4096)
+    {
+        segmented.append(httpRequest.substr(pos, 4096));
+        result = context.parseRequest(&segmented, receiveTime);
+    }
+    assert(result == false);
+
+    std::cout << "HttpContext headers too large test passed!" << std::endl;
+}
+
+void testRequestLineTooLong(HttpContext& context)
+{
+    muduo::Timestamp receiveTime = muduo::Timestamp::now();
+    const std::string target = "/" + std::string(16 * 1024, 'a');
+
+    // 一直等不到CRLF
+    muduo::net::Buffer buffer;
+    buffer.append("GET " + target);
+    bool result = context.parseRequest(&buffer, receiveTime);
+    assert(result == false);
+
+    // 完整到达但超长
+    context.reset();
+    muduo::net::Buffer complete;
+    complete.append("GET " + target + " HTTP/1.1\r\nHost: a\r\n\r\n");
+    result = context.parseRequest(&complete, receiveTime);
+    assert(result == false);
+
+    std::cout << "HttpContext request line too long test passed!" << std::endl;
+}
 
 int main() {
     // 创建 HttpContext 对象
@@ -83,6 +421,33 @@ int main() {
     context.reset();
     // 测试 POST 请求解析
     testPost(context);
+    context.reset();
+    // 测试分段到达的请求解析
+    testSegmented(context);
+    context.reset();
+    // 测试大量请求头解析
+    testManyHeaders(context);
+    context.reset();
+    // 测试长连接复用
+    testKeepAlive(context);
+    context.reset();
+    // 测试流水线请求
+    testPipelined(context);
+    context.reset();
+    // 测试chunked请求体
+    testChunked(context);
+    context.reset();
+    // 测试流式请求体与背压
+    testStreamingBody(context);
+    context.reset();
+    // 测试非法的Content-Length
+    testInvalidContentLength(context);
+    context.reset();
+    // 测试超长请求头
+    testHeadersTooLarge(context);
+    context.reset();
+    // 测试超长请求行
+    testRequestLineTooLong(context);
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "./gtest/gtest.h"
+#include <memory>
+#include <string>
+#include <muduo/net/Buffer.h>
+#include "http/HttpResponse.h"
+
+using namespace tinyHttp;
+
+// 只序列化头部，检查headSize()与实际写入的字节数一致
+static std::string head(const HttpResponse &resp)
+{
+    muduo::net::Buffer buf;
+    resp.appendHeadToBuffer(&buf);
+    EXPECT_EQ(buf.readableBytes(), resp.headSize());
+    return buf.retrieveAllAsString();
+}
+
+static std::string serialize(const HttpResponse &resp)
+{
+    muduo::net::Buffer buf;
+    resp.appendToBuffer(&buf);
+    EXPECT_EQ(buf.readableBytes(), resp.serializedSize());
+    return buf.retrieveAllAsString();
+}
+
+// 长连接：Connection头部紧跟状态行，自定义头部按设置顺序输出，重复设置时覆盖
+TEST(HttpResponseTest, KeepAliveBytes)
+{
+    HttpResponse resp(false);
+    resp.setStatusLine("HTTP/1.1", HttpResponse::k200Ok, "OK");
+    resp.setContentType("text/plain");
+    resp.addHeader("X-Custom", "a");
+    resp.addHeader("x-custom", "b");
+    resp.setContentLength(5);
+    resp.setBody("hello");
+
+    const std::string expectedHead =
+        "HTTP/1.1 200 OK\r\n"
+        "Connection: Keep-Alive\r\n"
+        "Content-Type: text/plain\r\n"
+        "X-Custom: b\r\n"
+        "Content-Length: 5\r\n"
+        "\r\n";
+    EXPECT_EQ(head(resp), expectedHead);
+    EXPECT_EQ(serialize(resp), expectedHead + "hello");
+}
+
+// 短连接与自定义状态消息；用户设置的Connection头部只改变连接行为，不会重复输出
+TEST(HttpResponseTest, CloseBytes)
+{
+    HttpResponse resp(false);
+    resp.setStatusLine("HTTP/1.0", HttpResponse::k404NotFound, "Nothing Here");
+    resp.addHeader("Connection", "close");
+    resp.setBody("");
+
+    EXPECT_TRUE(resp.closeConnection());
+    EXPECT_EQ(serialize(resp),
+              "HTTP/1.0 404 Nothing Here\r\n"
+              "Connection: close\r\n"
+              "\r\n");
+
+    HttpResponse unknown(true);
+    unknown.setVersion("HTTP/1.1");
+    unknown.setStatusCode(HttpResponse::k429TooManyRequests);
+    unknown.addHeader("Retry-After", "1");
+    EXPECT_EQ(head(unknown),
+              "HTTP/1.1 429 Too Many Requests\r\n"
+              "Connection: close\r\n"
+              "Retry-After: 1\r\n"
+              "\r\n");
+}
+
+// 预序列化的头部块原样写在其他头部之后
+TEST(HttpResponseTest, RawHeaders)
+{
+    HttpResponse resp(false);
+    resp.setStatusLine("HTTP/1.1", HttpResponse::k200Ok, "OK");
+    resp.addHeader("Content-Length", "2");
+    resp.setRawHeaders(std::make_shared<const std::string>("Cache-Control: max-age=60\r\nX-Raw: 1\r\n"));
+    resp.setBody("{}");
+    EXPECT_EQ(serialize(resp),
+              "HTTP/1.1 200 OK\r\n"
+              "Connection: Keep-Alive\r\n"
+              "Content-Length: 2\r\n"
+              "Cache-Control: max-age=60\r\n"
+              "X-Raw: 1\r\n"
+              "\r\n"
+              "{}");
+}
+
+// 共享响应体不拷贝：多个响应引用同一块数据，头部与响应体分开发送时拼接结果与整体序列化相同
+TEST(HttpResponseTest, SharedBody)
+{
+    auto body = std::make_shared<const std::string>(64 * 1024, 'x');
+    HttpResponse first(false);
+    first.setStatusLine("HTTP/1.1", HttpResponse::k200Ok, "OK");
+    first.setContentLength(body->size());
+    first.setBody(body);
+    HttpResponse second(true);
+    second.setStatusLine("HTTP/1.1", HttpResponse::k200Ok, "OK");
+    second.setBody(body);
+
+    EXPECT_EQ(first.body().data(), body->data());
+    EXPECT_EQ(second.body().data(), body->data());
+    EXPECT_EQ(body.use_count(), 3);
+
+    const std::string expectedHead =
+        "HTTP/1.1 200 OK\r\n"
+        "Connection: Keep-Alive\r\n"
+        "Content-Length: 65536\r\n"
+        "\r\n";
+    EXPECT_EQ(serialize(first), expectedHead + *body);
+    EXPECT_EQ(head(first) + std::string(first.body()), serialize(first));
+    EXPECT_EQ(serialize(second), "HTTP/1.1 200 OK\r\nConnection: close\r\n\r\n" + *body);
+
+    // 重新设置普通响应体后释放共享数据
+    first.setBody("ok");
+    EXPECT_EQ(body.use_count(), 2);
+    EXPECT_EQ(first.body(), "ok");
+
+    // 别名构造：只引用数据的一部分，所有者保持存活
+    auto owner = std::make_shared<const std::string>("0123456789");
+    second.setBody(std::shared_ptr<const char>(owner, owner->data() + 2), 3);
+    EXPECT_EQ(second.body(), "234");
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
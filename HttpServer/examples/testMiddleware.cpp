@@ -0,0 +1,590 @@
+#include "./gtest/gtest.h"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+#include <muduo/net/Buffer.h>
+#include "middleware/CompressionMiddleware.h"
+#include "middleware/MiddlewareChain.h"
+#include "middleware/RateLimitMiddleware.h"
+#include "middleware/ResponseCacheMiddleware.h"
+#include "middleware/StaticMiddlewareChain.h"
+#include "http/HttpResponse.h"
+#include "http/HttpRequest.h"
+
+using namespace tinyHttp;
+
+static HttpRequest makeRequest(HttpRequest::Method method, const std::string &path)
+{
+    HttpRequest req;
+    req.setMethod(method);
+    req.setPath(path);
+    return req;
+}
+
+// 记录调用顺序的中间件，reject为true时在before()中直接生成401响应
+class RecordingMiddleware : public Middleware
+{
+public:
+    RecordingMiddleware(std::string name, std::vector<std::string> &log, bool reject = false)
+        : name_(std::move(name)), log_(log), reject_(reject) {}
+
+    bool before(HttpRequest &, HttpResponse &response) override
+    {
+        log_.push_back(name_ + ".before");
+        if (reject_)
+        {
+            response.setStatusCode(HttpResponse::k401Unauthorized);
+            return false;
+        }
+        return true;
+    }
+
+    void after(const HttpRequest &, HttpResponse &) override
+    {
+        log_.push_back(name_ + ".after");
+    }
+
+private:
+    std::string               name_;
+    std::vector<std::string> &log_;
+    bool                      reject_;
+};
+
+// 依次执行选出的中间件数组，返回是否到达了路由
+static bool run(MiddlewareChain &chain, HttpRequest &req, HttpResponse &resp)
+{
+    const MiddlewareChain::Pipeline &pipeline = chain.select(req);
+    size_t passed = 0;
+    const bool reached = MiddlewareChain::handleRequest(pipeline, req, resp, &passed);
+    MiddlewareChain::handleResponse(pipeline, passed, req, resp);
+    return reached;
+}
+
+// 全局中间件按注册顺序执行before()，逆序执行after()
+TEST(MiddlewareTest, OrderAndNesting)
+{
+    std::vector<std::string> log;
+    MiddlewareChain chain;
+    chain.registerMiddleware(std::make_shared<RecordingMiddleware>("a", log));
+    chain.registerMiddleware(std::make_shared<RecordingMiddleware>("b", log));
+
+    HttpRequest req = makeRequest(HttpRequest::kGet, "/");
+    HttpResponse resp;
+    EXPECT_TRUE(run(chain, req, resp));
+    EXPECT_EQ(log, (std::vector<std::string>{"a.before", "b.before", "b.after", "a.after"}));
+}
+
+// 中间件可以短路：之后的中间件不再执行，after()只对放行了请求的中间件调用
+TEST(MiddlewareTest, ShortCircuit)
+{
+    std::vector<std::string> log;
+    MiddlewareChain chain;
+    chain.registerMiddleware(std::make_shared<RecordingMiddleware>("log", log));
+    chain.registerMiddleware(std::make_shared<RecordingMiddleware>("auth", log, true));
+    chain.registerMiddleware(std::make_shared<RecordingMiddleware>("inner", log));
+
+    HttpRequest req = makeRequest(HttpRequest::kGet, "/private");
+    HttpResponse resp;
+    EXPECT_FALSE(run(chain, req, resp));
+    EXPECT_EQ(resp.getStatusCode(), HttpResponse::k401Unauthorized);
+    EXPECT_EQ(log, (std::vector<std::string>{"log.before", "auth.before", "log.after"}));
+}
+
+// 前缀与路由绑定：/static不经过/api的鉴权，精确路由额外执行自己的中间件
+TEST(MiddlewareTest, PrefixAndRouteBinding)
+{
+    std::vector<std::string> log;
+    MiddlewareChain chain;
+    chain.registerMiddleware(std::make_shared<RecordingMiddleware>("global", log));
+    chain.registerMiddleware("/api/", std::make_shared<RecordingMiddleware>("auth", log));
+    chain.registerMiddleware("/api/v2", std::make_shared<RecordingMiddleware>("v2", log));
+    EXPECT_TRUE(chain.registerRouteMiddleware(HttpRequest::kPost, "/api/v2/upload",
+                                              std::make_shared<RecordingMiddleware>("upload", log)));
+    // 动态路由模式按请求路径精确查找永远不会匹配，注册时拒绝
+    EXPECT_FALSE(chain.registerRouteMiddleware(HttpRequest::kGet, "/api/users/:id",
+                                               std::make_shared<RecordingMiddleware>("user", log)));
+    EXPECT_FALSE(chain.registerRouteMiddleware(HttpRequest::kGet, "/api/files/*path",
+                                               std::make_shared<RecordingMiddleware>("file", log)));
+    chain.compile();
+
+    auto names = [&](HttpRequest::Method method, const std::string &path) {
+        log.clear();
+        HttpRequest req = makeRequest(method, path);
+        HttpResponse resp;
+        run(chain, req, resp);
+        std::vector<std::string> befores;
+        for (const auto &entry : log)
+        {
+            if (entry.size() > 7 && entry.compare(entry.size() - 7, 7, ".before") == 0)
+            {
+                befores.push_back(entry.substr(0, entry.size() - 7));
+            }
+        }
+        return befores;
+    };
+
+    EXPECT_EQ(names(HttpRequest::kGet, "/static/app.js"), (std::vector<std::string>{"global"}));
+    EXPECT_EQ(names(HttpRequest::kGet, "/apix"), (std::vector<std::string>{"global"}));
+    EXPECT_EQ(names(HttpRequest::kGet, "/api"), (std::vector<std::string>{"global", "auth"}));
+    EXPECT_EQ(names(HttpRequest::kGet, "/api/v2/items"), (std::vector<std::string>{"global", "auth", "v2"}));
+    EXPECT_EQ(names(HttpRequest::kGet, "/api/v2/upload"), (std::vector<std::string>{"global", "auth", "v2"}));
+    EXPECT_EQ(names(HttpRequest::kPost, "/api/v2/upload"),
+              (std::vector<std::string>{"global", "auth", "v2", "upload"}));
+    EXPECT_EQ(names(HttpRequest::kGet, "/api/users/:id"), (std::vector<std::string>{"global", "auth"}));
+}
+
+// 未显式compile()时多个线程同时第一次选择，只生成一次中间件数组且各线程得到相同结果
+TEST(MiddlewareTest, ConcurrentLazyCompile)
+{
+    std::vector<std::string> log;
+    MiddlewareChain chain;
+    chain.registerMiddleware(std::make_shared<RecordingMiddleware>("global", log));
+    chain.registerMiddleware("/api", std::make_shared<RecordingMiddleware>("auth", log));
+
+    std::vector<size_t> sizes(8);
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < sizes.size(); ++t)
+    {
+        threads.emplace_back([&, t] {
+            HttpRequest req = makeRequest(HttpRequest::kGet, "/api/items");
+            sizes[t] = chain.select(req).size();
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(sizes, std::vector<size_t>(sizes.size(), 2));
+}
+
+// 编译期组合的中间件，不继承Middleware，只提供同签名的before/after
+template <int Id, bool Reject = false>
+struct StaticStep
+{
+    std::vector<std::string> *log = nullptr;
+
+    bool before(HttpRequest &, HttpResponse &response)
+    {
+        log->push_back(std::to_string(Id) + ".before");
+        if (Reject)
+        {
+            response.setStatusCode(HttpResponse::k403Forbidden);
+        }
+        return !Reject;
+    }
+
+    void after(const HttpRequest &, HttpResponse &)
+    {
+        log->push_back(std::to_string(Id) + ".after");
+    }
+};
+
+// 静态链与动态链语义一致，短路时链内已放行的中间件立即执行after()；静态链可以作为整体注册进动态链
+TEST(MiddlewareTest, StaticChain)
+{
+    std::vector<std::string> log;
+    StaticMiddlewareChain<StaticStep<1>, StaticStep<2>> chain;
+    chain.get<0>().log = &log;
+    chain.get<1>().log = &log;
+
+    HttpRequest req = makeRequest(HttpRequest::kGet, "/");
+    HttpResponse resp;
+    bool handled = false;
+    chain.handle(req, resp, [&](HttpRequest &, HttpResponse &) { handled = true; log.push_back("handler"); });
+    EXPECT_TRUE(handled);
+    EXPECT_EQ(log, (std::vector<std::string>{"1.before", "2.before", "handler", "2.after", "1.after"}));
+
+    log.clear();
+    auto rejecting = std::make_shared<StaticMiddlewareChain<StaticStep<1>, StaticStep<2, true>, StaticStep<3>>>();
+    rejecting->get<0>().log = &log;
+    rejecting->get<1>().log = &log;
+    rejecting->get<2>().log = &log;
+    MiddlewareChain dynamic;
+    dynamic.registerMiddleware(std::make_shared<RecordingMiddleware>("outer", log));
+    dynamic.registerMiddleware(rejecting);
+
+    HttpResponse rejected;
+    EXPECT_FALSE(run(dynamic, req, rejected));
+    EXPECT_EQ(rejected.getStatusCode(), HttpResponse::k403Forbidden);
+    EXPECT_EQ(log, (std::vector<std::string>{"outer.before", "1.before", "2.before", "1.after", "outer.after"}));
+}
+
+static void addHeader(HttpRequest &req, const std::string &line)
+{
+    req.addHeader(line.data(), line.data() + line.size());
+}
+
+static std::string serialize(const HttpResponse &resp)
+{
+    muduo::net::Buffer buf;
+    resp.appendToBuffer(&buf);
+    return buf.retrieveAllAsString();
+}
+
+// 响应缓存：命中时短路路由并输出与首次响应相同的字节；查询参数顺序不影响命中；
+// Cache-Control、Accept-Encoding与失效接口按预期生效
+TEST(MiddlewareTest, ResponseCache)
+{
+    auto cache = std::make_shared<ResponseCacheMiddleware>(60.0);
+    MiddlewareChain chain;
+    chain.registerMiddleware(cache);
+
+    int calls = 0;
+    std::string cacheControl;
+    // 模拟一次完整的请求处理，返回序列化后的响应
+    auto handle = [&](const std::string &path, const std::string &query,
+                      const std::vector<std::string> &headers, bool close = false) {
+        HttpRequest req = makeRequest(HttpRequest::kGet, path);
+        req.setVersion("HTTP/1.1");
+        req.setQueryParameters(query.data(), query.data() + query.size());
+        for (const auto &header : headers)
+        {
+            addHeader(req, header);
+        }
+        HttpResponse resp(close);
+        resp.setVersion("HTTP/1.1");
+        const MiddlewareChain::Pipeline &pipeline = chain.select(req);
+        size_t passed = 0;
+        if (MiddlewareChain::handleRequest(pipeline, req, resp, &passed))
+        {
+            ++calls;
+            resp.setStatusCode(HttpResponse::k200Ok);
+            resp.setContentType("application/json");
+            if (!cacheControl.empty())
+            {
+                resp.addHeader("Cache-Control", cacheControl);
+            }
+            resp.setBody("{\"items\":" + std::to_string(calls) + "}");
+        }
+        MiddlewareChain::handleResponse(pipeline, passed, req, resp);
+        return serialize(resp);
+    };
+
+    const std::string first = handle("/items", "b=2&a=1", {});
+    EXPECT_EQ(calls, 1);
+    EXPECT_NE(first.find("Content-Length: 11"), std::string::npos);
+    EXPECT_EQ(handle("/items", "a=1&b=2", {}), first);
+    EXPECT_EQ(calls, 1);
+    EXPECT_EQ(cache->size(), 1u);
+
+    // 需要关闭连接的请求只替换Connection头部
+    const std::string closed = handle("/items", "a=1&b=2", {}, true);
+    EXPECT_EQ(calls, 1);
+    EXPECT_NE(closed.find("Connection: close\r\n"), std::string::npos);
+    EXPECT_EQ(closed.substr(closed.find("\r\n\r\n")), first.substr(first.find("\r\n\r\n")));
+
+    // 接受的压缩编码不同则是不同的缓存项；带Authorization或no-cache的请求不使用缓存
+    handle("/items", "a=1&b=2", {"Accept-Encoding: gzip"});
+    EXPECT_EQ(calls, 2);
+    handle("/items", "a=1&b=2", {"Accept-Encoding: gzip, deflate"});
+    EXPECT_EQ(calls, 2);
+    handle("/items", "a=1&b=2", {"Authorization: Bearer x"});
+    EXPECT_EQ(calls, 3);
+    handle("/items", "a=1&b=2", {"Cache-Control: no-cache"});
+    EXPECT_EQ(calls, 4);
+
+    // 响应声明no-store或max-age=0时不缓存
+    cacheControl = "no-store";
+    handle("/private", "", {});
+    handle("/private", "", {});
+    EXPECT_EQ(calls, 6);
+    cacheControl = "public, max-age=0";
+    handle("/volatile", "", {});
+    handle("/volatile", "", {});
+    EXPECT_EQ(calls, 8);
+
+    cacheControl.clear();
+    cache->invalidate("/items");
+    handle("/items", "a=1&b=2", {});
+    EXPECT_EQ(calls, 9);
+
+    // 同名参数的顺序决定处理函数取到的值，不同顺序是不同的缓存项
+    const std::string ascending = handle("/repeat", "a=1&a=2", {});
+    const std::string descending = handle("/repeat", "a=2&a=1", {});
+    EXPECT_EQ(calls, 11);
+    EXPECT_NE(ascending, descending);
+    EXPECT_EQ(handle("/repeat", "a=1&a=2", {}), ascending);
+    EXPECT_EQ(handle("/repeat", "a=2&a=1", {}), descending);
+    EXPECT_EQ(calls, 11);
+}
+
+// 带Cookie的请求默认不缓存，避免会话用户的个性化响应被其他用户命中；
+// 响应的Vary列出不在缓存键中的请求头或为*时不缓存
+TEST(MiddlewareTest, ResponseCacheCookieAndVary)
+{
+    auto cache = std::make_shared<ResponseCacheMiddleware>(60.0);
+    MiddlewareChain chain;
+    chain.registerMiddleware(cache);
+
+    int calls = 0;
+    std::string vary;
+    auto handle = [&](const std::string &path, const std::vector<std::string> &headers) {
+        HttpRequest req = makeRequest(HttpRequest::kGet, path);
+        req.setVersion("HTTP/1.1");
+        for (const auto &header : headers)
+        {
+            addHeader(req, header);
+        }
+        HttpResponse resp(false);
+        resp.setVersion("HTTP/1.1");
+        const MiddlewareChain::Pipeline &pipeline = chain.select(req);
+        size_t passed = 0;
+        if (MiddlewareChain::handleRequest(pipeline, req, resp, &passed))
+        {
+            ++calls;
+            resp.setStatusCode(HttpResponse::k200Ok);
+            resp.setContentType("text/plain");
+            if (!vary.empty())
+            {
+                resp.addHeader("Vary", vary);
+            }
+            resp.setBody("user " + std::to_string(calls));
+        }
+        MiddlewareChain::handleResponse(pipeline, passed, req, resp);
+        return serialize(resp);
+    };
+
+    handle("/me", {"Cookie: sessionId=alice"});
+    const std::string bob = handle("/me", {"Cookie: sessionId=bob"});
+    EXPECT_EQ(calls, 2);
+    EXPECT_NE(bob.find("user 2"), std::string::npos);
+    EXPECT_EQ(cache->size(), 0u);
+
+    // 响应按Origin区分而Origin不在缓存键中
+    vary = "Origin";
+    handle("/cors", {"Origin: http://a.example"});
+    handle("/cors", {"Origin: http://b.example"});
+    EXPECT_EQ(calls, 4);
+    vary = "*";
+    handle("/any", {});
+    handle("/any", {});
+    EXPECT_EQ(calls, 6);
+    EXPECT_EQ(cache->size(), 0u);
+
+    // Vary中的请求头都在缓存键中时照常缓存
+    vary = "accept-encoding";
+    handle("/plain", {});
+    handle("/plain", {});
+    EXPECT_EQ(calls, 7);
+
+    // Cookie参与缓存键后按Cookie分别缓存
+    cache->addVaryHeader("Cookie");
+    vary = "Cookie";
+    handle("/me", {"Cookie: sessionId=alice"});
+    handle("/me", {"Cookie: sessionId=bob"});
+    EXPECT_NE(handle("/me", {"Cookie: sessionId=alice"}).find("user 8"), std::string::npos);
+    EXPECT_EQ(calls, 9);
+}
+
+static std::string inflateBody(std::string_view data, int windowBits)
+{
+    z_stream zs = {};
+    inflateInit2(&zs, windowBits);
+    std::string out(64 * 1024, '\0');
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    const int ret = inflate(&zs, Z_FINISH);
+    out.resize(ret == Z_STREAM_END ? zs.total_out : 0);
+    inflateEnd(&zs);
+    return out;
+}
+
+// 按Accept-Encoding选择gzip或deflate，压缩后更新Content-Length，强ETag改为弱ETag，Vary追加而不是覆盖
+TEST(MiddlewareTest, Compression)
+{
+    CompressionMiddleware compression(1024);
+    std::string text;
+    for (int i = 0; i < 100; ++i)
+    {
+        text += "compressible line " + std::to_string(i) + "\n";
+    }
+    ASSERT_GE(text.size(), 1024u);
+
+    auto respond = [&](const std::string &acceptEncoding, HttpResponse *resp) {
+        HttpRequest req = makeRequest(HttpRequest::kGet, "/");
+        if (!acceptEncoding.empty())
+        {
+            addHeader(req, "Accept-Encoding: " + acceptEncoding);
+        }
+        compression.after(req, *resp);
+    };
+    auto textResponse = [&](HttpResponse *resp) {
+        resp->setStatusCode(HttpResponse::k200Ok);
+        resp->setContentType("text/plain");
+        resp->setContentLength(text.size());
+        resp->setBody(text);
+    };
+
+    HttpResponse gzip;
+    textResponse(&gzip);
+    gzip.addHeader("ETag", "\"v1\"");
+    gzip.addHeader("Vary", "Origin");
+    respond("gzip, deflate", &gzip);
+    EXPECT_EQ(gzip.getHeader("Content-Encoding"), "gzip");
+    EXPECT_EQ(gzip.getHeader("Content-Length"), std::to_string(gzip.body().size()));
+    EXPECT_EQ(gzip.getHeader("ETag"), "W/\"v1\"");
+    EXPECT_EQ(gzip.getHeader("Vary"), "Origin, Accept-Encoding");
+    EXPECT_EQ(inflateBody(gzip.body(), 15 + 16), text);
+
+    HttpResponse deflate;
+    textResponse(&deflate);
+    deflate.addHeader("ETag", "W/\"v1\"");
+    deflate.addHeader("Vary", "accept-encoding");
+    respond("deflate", &deflate);
+    EXPECT_EQ(deflate.getHeader("Content-Encoding"), "deflate");
+    EXPECT_EQ(deflate.getHeader("ETag"), "W/\"v1\"");
+    EXPECT_EQ(deflate.getHeader("Vary"), "accept-encoding");
+    EXPECT_EQ(inflateBody(deflate.body(), 15), text);
+
+    // 客户端不接受压缩：响应不变，但仍带Vary
+    HttpResponse identity;
+    textResponse(&identity);
+    identity.addHeader("ETag", "\"v1\"");
+    respond("", &identity);
+    EXPECT_EQ(identity.body(), text);
+    EXPECT_TRUE(identity.getHeader("Content-Encoding").empty());
+    EXPECT_EQ(identity.getHeader("ETag"), "\"v1\"");
+    EXPECT_EQ(identity.getHeader("Vary"), "Accept-Encoding");
+
+    // 小于最小长度、不可压缩类型、已有Content-Encoding的响应都不处理
+    HttpResponse small;
+    small.setContentType("text/plain");
+    small.setBody(std::string(100, 'a'));
+    respond("gzip", &small);
+    EXPECT_EQ(small.body(), std::string(100, 'a'));
+    EXPECT_TRUE(small.getHeader("Vary").empty());
+
+    // 媒体类型不区分大小写
+    HttpResponse upper;
+    upper.setContentType("Application/JSON");
+    upper.setBody(text);
+    respond("gzip", &upper);
+    EXPECT_EQ(upper.getHeader("Content-Encoding"), "gzip");
+    EXPECT_EQ(inflateBody(upper.body(), 15 + 16), text);
+
+    HttpResponse image;
+    image.setContentType("image/png");
+    image.setBody(text);
+    respond("gzip", &image);
+    EXPECT_EQ(image.body(), text);
+    EXPECT_TRUE(image.getHeader("Content-Encoding").empty());
+
+    HttpResponse encoded;
+    textResponse(&encoded);
+    encoded.addHeader("Content-Encoding", "br");
+    respond("gzip", &encoded);
+    EXPECT_EQ(encoded.body(), text);
+    EXPECT_EQ(encoded.getHeader("Content-Encoding"), "br");
+}
+
+// 限流：同一客户端最多连续通过burst个请求，之后返回429；不同客户端互不影响，按请求头限流时以头部值区分
+TEST(MiddlewareTest, RateLimit)
+{
+    auto limiter = std::make_shared<RateLimitMiddleware>(0.001, 3);
+    MiddlewareChain chain;
+    chain.registerMiddleware(limiter);
+
+    auto send = [&](const std::string &ip, HttpResponse *resp) {
+        HttpRequest req = makeRequest(HttpRequest::kGet, "/");
+        req.setPeerAddress(ip);
+        return run(chain, req, *resp);
+    };
+    for (int i = 0; i < 3; ++i)
+    {
+        HttpResponse resp;
+        EXPECT_TRUE(send("10.0.0.1", &resp));
+    }
+    HttpResponse rejected;
+    EXPECT_FALSE(send("10.0.0.1", &rejected));
+    EXPECT_EQ(rejected.getStatusCode(), HttpResponse::k429TooManyRequests);
+    EXPECT_FALSE(rejected.getHeader("Retry-After").empty());
+    HttpResponse other;
+    EXPECT_TRUE(send("10.0.0.2", &other));
+    EXPECT_EQ(limiter->size(), 2u);
+
+    // 令牌未补满的桶不会被当作空闲清理
+    EXPECT_EQ(limiter->evictIdle(60.0), 0u);
+    EXPECT_EQ(limiter->evictIdle(-1e7), 2u);
+    EXPECT_EQ(limiter->size(), 0u);
+
+    RateLimitMiddleware byKey(0.001, 1, "X-Api-Key");
+    HttpRequest a = makeRequest(HttpRequest::kGet, "/");
+    a.setPeerAddress("10.0.0.3");
+    addHeader(a, "X-Api-Key: alpha");
+    HttpRequest b = makeRequest(HttpRequest::kGet, "/");
+    b.setPeerAddress("10.0.0.3");
+    addHeader(b, "X-Api-Key: beta");
+    HttpResponse resp;
+    EXPECT_TRUE(byKey.before(a, resp));
+    EXPECT_TRUE(byKey.before(b, resp));
+    EXPECT_FALSE(byKey.before(a, resp));
+}
+
+// 桶数量有上限：伪造大量不同的X-Api-Key时桶数不超过上限，超出的请求退回按IP限流；
+// 令牌已补满的桶在分段满时就地清理，不依赖startEviction()
+TEST(MiddlewareTest, RateLimitBucketCap)
+{
+    const size_t maxBuckets = RateLimitMiddleware::kShards * 2;
+    RateLimitMiddleware byKey(0.001, 1, "X-Api-Key", maxBuckets);
+    int allowed = 0;
+    for (int i = 0; i < 2000; ++i)
+    {
+        HttpRequest req = makeRequest(HttpRequest::kGet, "/");
+        req.setPeerAddress("10.0.0.9");
+        addHeader(req, "X-Api-Key: key" + std::to_string(i));
+        HttpResponse resp;
+        if (byKey.before(req, resp))
+        {
+            ++allowed;
+        }
+        else
+        {
+            EXPECT_EQ(resp.getStatusCode(), HttpResponse::k429TooManyRequests);
+        }
+    }
+    EXPECT_LE(byKey.size(), maxBuckets);
+    EXPECT_LE(allowed, static_cast<int>(maxBuckets));
+    EXPECT_FALSE(byKey.tryAcquire("10.0.0.9"));
+
+    RateLimitMiddleware fast(1e6, 1, std::string(), maxBuckets);
+    for (int i = 0; i < 2000; ++i)
+    {
+        EXPECT_TRUE(fast.tryAcquire("client" + std::to_string(i)));
+        std::this_thread::sleep_for(std::chrono::microseconds(2));
+    }
+    EXPECT_LE(fast.size(), maxBuckets);
+}
+
+// 多个线程同时为同一客户端取令牌，通过的请求数恰好等于burst
+TEST(MiddlewareTest, RateLimitConcurrent)
+{
+    RateLimitMiddleware limiter(0.001, 1000);
+    std::atomic<int> allowed{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i)
+            {
+                allowed += limiter.tryAcquire("client");
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_EQ(allowed.load(), 1000);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
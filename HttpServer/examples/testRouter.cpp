@@ -1,11 +1,16 @@
 #include "./gtest/gtest.h"
 #include <chrono>
 #include <iostream>
+#include <array>
 #include <atomic>
+#include <thread>
+#include <vector>
 #include "router/Router.h"
 #include "http/HttpResponse.h"
 #include "http/HttpRequest.h"
 
+using namespace tinyHttp;
+
 // 注意：下面的 makeRequest 可能需根据你项目中 HttpRequest 的实际 API 调整。
 // 假设存在默认构造 + setMethod/setPath 或构造函数 (Method, path)。
 // 如果项目提供不同构造，请在此处替换为真实构造调用。
@@ -91,7 +96,10 @@ TEST(RouterTest, RegexCallbackMatchAndMiss)
     // 动态路由模式示例：/user/:id/profile/:section
     router.addRegexCallback(HttpRequest::Method::kGet, "/user/:id/profile/:section",
                             [&](const HttpRequest &req, HttpResponse *resp) {
-                                (void)req; (void)resp;
+                                (void)resp;
+                                // 路径参数以模式中声明的名字获取
+                                EXPECT_EQ(req.getPathParameters("id"), "123");
+                                EXPECT_EQ(req.getPathParameters("section"), "overview");
                                 ++hitCount;
                             });
 
@@ -113,6 +121,84 @@ TEST(RouterTest, RegexCallbackMatchAndMiss)
     ASSERT_EQ(hitCount.load(), 1);
 }
 
+// 前缀树路由：普通段优先于参数段，参数段优先于通配段，匹配失败时回溯
+TEST(RouterTest, TriePriorityAndWildcard)
+{
+    Router router;
+    std::string hit;
+    auto routePath = [&](HttpRequest::Method method, const std::string &path) {
+        HttpRequest req = makeRequest(method, path);
+        return router.route(req, nullptr);
+    };
+
+    router.addRegexCallback(HttpRequest::Method::kGet, "/user/:id",
+                            [&](const HttpRequest &, HttpResponse *) { hit = "param"; });
+    router.addRegexCallback(HttpRequest::Method::kGet, "/user/me",
+                            [&](const HttpRequest &, HttpResponse *) { hit = "static"; });
+    router.addRegexCallback(HttpRequest::Method::kGet, "/user/me/settings/:tab",
+                            [&](const HttpRequest &, HttpResponse *) { hit = "backtrack"; });
+    router.addRegexCallback(HttpRequest::Method::kGet, "/static/*filepath",
+                            [&](const HttpRequest &req, HttpResponse *) {
+                                hit = "wildcard";
+                                EXPECT_EQ(req.getPathParameters("filepath"), "css/site/main.css");
+                            });
+
+    ASSERT_TRUE(routePath(HttpRequest::Method::kGet, "/user/me"));
+    ASSERT_EQ(hit, "static");
+    ASSERT_TRUE(routePath(HttpRequest::Method::kGet, "/user/42"));
+    ASSERT_EQ(hit, "param");
+    ASSERT_TRUE(routePath(HttpRequest::Method::kGet, "/user/me/settings/privacy"));
+    ASSERT_EQ(hit, "backtrack");
+    ASSERT_TRUE(routePath(HttpRequest::Method::kGet, "/static/css/site/main.css"));
+    ASSERT_EQ(hit, "wildcard");
+
+    ASSERT_FALSE(routePath(HttpRequest::Method::kGet, "/user/42/extra"));
+    ASSERT_FALSE(routePath(HttpRequest::Method::kGet, "/user/"));
+    ASSERT_FALSE(routePath(HttpRequest::Method::kPost, "/static/a.js"));
+}
+
+// 注册大量结构相同的动态路由后，每个请求都分派到自己的处理函数并取得正确的参数；
+// 同时输出最后一条路由的平均匹配耗时供参考，不作为断言
+TEST(RouterTest, ManyDynamicRoutesResolve)
+{
+    Router router;
+    std::atomic<int> hitCount{0};
+    int lastRoute = -1;
+    const int routes = 500;
+    for (int i = 0; i < routes; ++i)
+    {
+        router.addRegexCallback(HttpRequest::Method::kGet, "/api/v1/resource" + std::to_string(i) + "/:id",
+                                [&, i](const HttpRequest &req, HttpResponse *) {
+                                    ++hitCount;
+                                    lastRoute = i;
+                                    EXPECT_EQ(req.getPathParameters("id"), "42");
+                                });
+    }
+
+    for (int i : {0, routes / 2, routes - 1})
+    {
+        HttpRequest req = makeRequest(HttpRequest::Method::kGet, "/api/v1/resource" + std::to_string(i) + "/42");
+        ASSERT_TRUE(router.route(req, nullptr));
+        EXPECT_EQ(lastRoute, i);
+    }
+    hitCount = 0;
+
+    HttpRequest req = makeRequest(HttpRequest::Method::kGet, "/api/v1/resource" + std::to_string(routes - 1) + "/42");
+    const int iterations = 10000;
+    auto t0 = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; ++i)
+    {
+        router.route(req, nullptr);
+    }
+    auto t1 = std::chrono::high_resolution_clock::now();
+    auto total_us = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
+
+    std::cout << "ManyDynamicRoutesResolve: routes=" << routes
+              << ", avg_us=" << static_cast<double>(total_us) / iterations << "\n";
+    ASSERT_EQ(hitCount.load(), iterations);
+    EXPECT_EQ(lastRoute, routes - 1);
+}
+
 // 性能与吞吐量测试（测量路由平均延迟、总耗时、吞吐量）
 // 说明：此测试为性能基准，运行大量次以获取数值指标，作为回归检测可调低次数。
 TEST(RouterTest, ThroughputAndLatency)
@@ -152,6 +238,255 @@ TEST(RouterTest, ThroughputAndLatency)
     ASSERT_GT(throughput, 0.0);
 }
 
+// 大量静态路由：完美哈希表对每个已注册路径都能命中，未注册的方法或路径不命中
+TEST(RouterTest, ManyStaticRoutes)
+{
+    Router router;
+    const int routeCount = 2000;
+    std::vector<int> hits(routeCount, 0);
+    for (int i = 0; i < routeCount; ++i)
+    {
+        router.registerCallback(HttpRequest::kGet, "/static/" + std::to_string(i),
+                                [&hits, i](const HttpRequest &, HttpResponse *) { ++hits[i]; });
+    }
+    router.compile();
+
+    for (int i = 0; i < routeCount; ++i)
+    {
+        HttpRequest req = makeRequest(HttpRequest::kGet, "/static/" + std::to_string(i));
+        ASSERT_TRUE(router.route(req, nullptr));
+        ASSERT_EQ(hits[i], 1);
+    }
+    HttpRequest wrongMethod = makeRequest(HttpRequest::kPost, "/static/7");
+    EXPECT_FALSE(router.route(wrongMethod, nullptr));
+    HttpRequest missing = makeRequest(HttpRequest::kGet, "/static/" + std::to_string(routeCount));
+    EXPECT_FALSE(router.route(missing, nullptr));
+}
+
+// 编译与热替换：注册修改在compile()之后才生效，clear()后重新注册再编译即可整体替换路由
+TEST(RouterTest, CompileAndHotSwap)
+{
+    Router router;
+    int oldHits = 0;
+    int newHits = 0;
+    router.registerCallback(HttpRequest::kGet, "/v1", [&](const HttpRequest &, HttpResponse *) { ++oldHits; });
+
+    // 未编译时第一次路由自动编译
+    HttpRequest v1 = makeRequest(HttpRequest::kGet, "/v1");
+    EXPECT_TRUE(router.route(v1, nullptr));
+    const uint64_t firstVersion = router.version();
+    EXPECT_NE(firstVersion, 0u);
+
+    router.registerCallback(HttpRequest::kGet, "/v2", [&](const HttpRequest &, HttpResponse *) { ++newHits; });
+    HttpRequest v2 = makeRequest(HttpRequest::kGet, "/v2");
+    EXPECT_FALSE(router.route(v2, nullptr));
+
+    router.compile();
+    EXPECT_NE(router.version(), firstVersion);
+    EXPECT_TRUE(router.route(v2, nullptr));
+
+    // 重新加载配置：清空后旧路由仍可用，编译后才被替换
+    router.clear();
+    router.addRegexCallback(HttpRequest::kGet, "/v3/:id", [&](const HttpRequest &, HttpResponse *) { ++newHits; });
+    EXPECT_TRUE(router.route(v1, nullptr));
+    router.compile();
+    EXPECT_FALSE(router.route(v1, nullptr));
+    HttpRequest v3 = makeRequest(HttpRequest::kGet, "/v3/42");
+    EXPECT_TRUE(router.route(v3, nullptr));
+    EXPECT_EQ(v3.getPathParameters("id"), "42");
+
+    EXPECT_EQ(oldHits, 2);
+    EXPECT_EQ(newHits, 2);
+}
+
+// 多个线程路由的同时反复热替换路由表，每次请求都应命中新旧路由表之一
+TEST(RouterTest, ConcurrentRouteDuringSwap)
+{
+    Router router;
+    std::atomic<int> hitCount{0};
+    auto callback = [&hitCount](const HttpRequest &, HttpResponse *) { hitCount.fetch_add(1, std::memory_order_relaxed); };
+    router.registerCallback(HttpRequest::kGet, "/ping", callback);
+    router.compile();
+
+    const int threadCount = 4;
+    const int requestsPerThread = 20000;
+    std::atomic<bool> done{false};
+    std::thread swapper([&] {
+        while (!done.load())
+        {
+            router.registerCallback(HttpRequest::kGet, "/ping", callback);
+            router.compile();
+        }
+    });
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < threadCount; ++t)
+    {
+        readers.emplace_back([&] {
+            for (int i = 0; i < requestsPerThread; ++i)
+            {
+                HttpRequest req = makeRequest(HttpRequest::kGet, "/ping");
+                router.route(req, nullptr);
+            }
+        });
+    }
+    for (auto &reader : readers)
+    {
+        reader.join();
+    }
+    done = true;
+    swapper.join();
+
+    ASSERT_EQ(hitCount.load(), threadCount * requestsPerThread);
+}
+
+// 处理器中热替换自身所在的Router并嵌套调用其他两层Router，返回前旧路由表及其中的处理器仍然有效
+TEST(RouterTest, NestedRoutingDuringSwap)
+{
+    Router outer;
+    Router middle;
+    Router inner;
+    int innerHits = 0;
+    inner.registerCallback(HttpRequest::kGet, "/leaf", [&](const HttpRequest &, HttpResponse *) { ++innerHits; });
+    middle.registerCallback(HttpRequest::kGet, "/leaf", [&](const HttpRequest &, HttpResponse *) {
+        HttpRequest req = makeRequest(HttpRequest::kGet, "/leaf");
+        inner.route(req, nullptr);
+    });
+
+    std::string seen;
+    const std::string tag(64, 'x'); // 处理器捕获的堆上数据，随旧路由表一起释放
+    outer.registerCallback(HttpRequest::kGet, "/root", [&, tag](const HttpRequest &, HttpResponse *) {
+        outer.registerCallback(HttpRequest::kGet, "/root", [](const HttpRequest &, HttpResponse *) {});
+        outer.compile();
+        HttpRequest req = makeRequest(HttpRequest::kGet, "/leaf");
+        middle.route(req, nullptr);
+        seen = tag;
+    });
+
+    HttpRequest req = makeRequest(HttpRequest::kGet, "/root");
+    ASSERT_TRUE(outer.route(req, nullptr));
+    EXPECT_EQ(seen, tag);
+    EXPECT_EQ(innerHits, 1);
+}
+
+// InlineHandler：小对象内联存放，大对象退化到堆上，拷贝与移动后都能正确调用与释放
+TEST(RouterTest, InlineHandlerStorage)
+{
+    auto counter = std::make_shared<int>(0);
+    InlineHandler small([counter](const HttpRequest &, HttpResponse *) { ++*counter; });
+    std::array<char, 256> payload{};
+    payload[0] = 1;
+    InlineHandler large([counter, payload](const HttpRequest &, HttpResponse *) { *counter += payload[0]; });
+
+    HttpRequest req = makeRequest(HttpRequest::kGet, "/");
+    InlineHandler smallCopy(small);
+    InlineHandler largeCopy(large);
+    InlineHandler moved(std::move(small));
+    EXPECT_FALSE(static_cast<bool>(small));
+    moved(req, nullptr);
+    smallCopy(req, nullptr);
+    largeCopy(req, nullptr);
+    large = smallCopy;
+    large(req, nullptr);
+    EXPECT_EQ(*counter, 4);
+
+    moved = InlineHandler();
+    smallCopy = InlineHandler();
+    large = InlineHandler();
+    largeCopy = InlineHandler();
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+// 对象式处理器与回调函数共用同一张路由表，同一路径后注册的覆盖先注册的
+TEST(RouterTest, UnifiedRouteOverride)
+{
+    Router router;
+    int callbackHits = 0;
+    std::atomic<int> handlerHits{0};
+    router.registerCallback(HttpRequest::kGet, "/same", [&](const HttpRequest &, HttpResponse *) { ++callbackHits; });
+    auto handler = std::make_shared<TestHandler>(handlerHits);
+    router.registerHandler(HttpRequest::kGet, "/same", handler);
+
+    HttpRequest req = makeRequest(HttpRequest::kGet, "/same");
+    ASSERT_TRUE(router.route(req, nullptr));
+    EXPECT_EQ(handlerHits.load(), 1);
+    EXPECT_EQ(callbackHits, 0);
+
+    Router::HandlerCallback callback = [&](const HttpRequest &, HttpResponse *) { ++callbackHits; };
+    router.registerCallback(HttpRequest::kGet, "/same", callback);
+    router.compile();
+    ASSERT_TRUE(router.route(req, nullptr));
+    EXPECT_EQ(handlerHits.load(), 1);
+    EXPECT_EQ(callbackHits, 1);
+}
+
+// 路由统计：按注册的路径/模式计数，多线程记录在读取时合并，并能以Prometheus格式输出
+TEST(RouterTest, RouteMetrics)
+{
+    Router router;
+    router.registerCallback(HttpRequest::kGet, "/ping", [](const HttpRequest &, HttpResponse *) {});
+    router.addRegexCallback(HttpRequest::kGet, "/user/:id", [](const HttpRequest &, HttpResponse *) {});
+    router.registerMetricsEndpoint();
+    router.compile();
+
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; ++t)
+    {
+        workers.emplace_back([&router, t] {
+            for (int i = 0; i < 100; ++i)
+            {
+                HttpRequest ping = makeRequest(HttpRequest::kGet, "/ping");
+                router.route(ping, nullptr);
+                HttpRequest user = makeRequest(HttpRequest::kGet, "/user/" + std::to_string(t * 100 + i));
+                router.route(user, nullptr);
+            }
+        });
+    }
+    for (auto &worker : workers)
+    {
+        worker.join();
+    }
+    HttpRequest missing = makeRequest(HttpRequest::kPost, "/nothing");
+    EXPECT_FALSE(router.route(missing, nullptr));
+
+    uint64_t pingCount = 0, userCount = 0, missCount = 0;
+    for (const auto &stats : router.metrics().snapshot())
+    {
+        if (stats.route == "/ping") pingCount = stats.count;
+        if (stats.route == "/user/:id") userCount = stats.count;
+        if (stats.route.empty() && stats.method == HttpRequest::kPost) missCount = stats.count;
+        EXPECT_GE(stats.percentile(0.99), stats.percentile(0.5));
+    }
+    EXPECT_EQ(pingCount, 400u);
+    EXPECT_EQ(userCount, 400u);
+    EXPECT_EQ(missCount, 1u);
+
+    HttpRequest scrape = makeRequest(HttpRequest::kGet, "/metrics");
+    HttpResponse resp;
+    ASSERT_TRUE(router.route(scrape, &resp));
+    const std::string body(resp.body());
+    EXPECT_NE(body.find("tinyhttp_route_requests_total{method=\"GET\",route=\"/user/:id\"} 400"), std::string::npos);
+    EXPECT_NE(body.find("tinyhttp_route_latency_seconds_count{method=\"GET\",route=\"/ping\"} 400"), std::string::npos);
+    EXPECT_NE(body.find("le=\"+Inf\""), std::string::npos);
+}
+
+// 直方图分桶：每个桶的上界与下一个桶的下界相接，相对误差不超过1/8
+TEST(RouterTest, LatencyHistogramBuckets)
+{
+    for (uint64_t v : {0ull, 1ull, 15ull, 16ull, 17ull, 100ull, 1000ull, 123456ull, 1ull << 30})
+    {
+        const size_t index = RouteMetrics::bucketIndex(v);
+        const uint64_t upper = RouteMetrics::bucketUpperBound(index);
+        EXPECT_GE(upper, v);
+        EXPECT_LE(upper - v, v / 8);
+        if (index > 0)
+        {
+            EXPECT_LT(RouteMetrics::bucketUpperBound(index - 1), v);
+        }
+    }
+    EXPECT_EQ(RouteMetrics::bucketIndex(UINT64_MAX), RouteMetrics::kBucketCount - 1);
+}
+
 // 路由失败率与边界测试：不存在路由
 TEST(RouterTest, NotFoundRoute)
 {
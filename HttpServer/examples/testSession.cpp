@@ -0,0 +1,132 @@
+#include "./gtest/gtest.h"
+#include <chrono>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "session/SessionManager.h"
+#include "session/SessionStorage.h"
+
+using namespace tinyHttp;
+
+static int64_t nowMillis()
+{
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+// 基本的保存、加载与移除
+TEST(SessionTest, SaveLoadRemove)
+{
+    MemorySessionStorage storage;
+    auto session = std::make_shared<Session>("abc", nullptr);
+    storage.save(session);
+    EXPECT_EQ(storage.load("abc"), session);
+    EXPECT_EQ(storage.load("missing"), nullptr);
+    storage.save(session);
+    EXPECT_EQ(storage.size(), 1u);
+    storage.remove("abc");
+    EXPECT_EQ(storage.load("abc"), nullptr);
+    EXPECT_EQ(storage.size(), 0u);
+}
+
+// 时间轮推进时只清理已过期的会话，过期时间超过一圈的会话保留到真正过期
+TEST(SessionTest, WheelExpiry)
+{
+    MemorySessionStorage storage;
+    const int64_t start = nowMillis();
+    for (int i = 0; i < 100; ++i)
+    {
+        storage.save(std::make_shared<Session>("short" + std::to_string(i), nullptr, 1));
+        storage.save(std::make_shared<Session>("long" + std::to_string(i), nullptr, 1000));
+    }
+    EXPECT_EQ(storage.removeExpired(start), 0u);
+    EXPECT_EQ(storage.removeExpired(start + 3000), 100u);
+    EXPECT_EQ(storage.size(), 100u);
+    EXPECT_NE(storage.load("long0"), nullptr);
+    EXPECT_EQ(storage.removeExpired(start + 600 * 1000), 0u);
+    EXPECT_EQ(storage.removeExpired(start + 1002 * 1000), 100u);
+    EXPECT_EQ(storage.size(), 0u);
+}
+
+// 到期前被刷新的会话按新的过期时间重新挂入时间轮
+TEST(SessionTest, RefreshReschedules)
+{
+    MemorySessionStorage storage(std::chrono::milliseconds(10));
+    auto session = std::make_shared<Session>("abc", nullptr, 1);
+    storage.save(session);
+    const int64_t firstExpiry = session->expiryMillis();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    session->refresh();
+    storage.save(session);
+    ASSERT_GE(session->expiryMillis(), firstExpiry + 50);
+
+    EXPECT_EQ(storage.removeExpired(firstExpiry + 25), 0u);
+    EXPECT_EQ(storage.size(), 1u);
+    EXPECT_EQ(storage.removeExpired(session->expiryMillis() + 25), 1u);
+    EXPECT_EQ(storage.size(), 0u);
+}
+
+// 各I/O线程并发读写会话的同时后台推进时间轮
+TEST(SessionTest, ConcurrentAccess)
+{
+    MemorySessionStorage storage(std::chrono::milliseconds(1));
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&storage, t] {
+            for (int i = 0; i < 2000; ++i)
+            {
+                const std::string id = std::to_string(t) + "-" + std::to_string(i % 100);
+                auto session = storage.load(id);
+                if (!session)
+                {
+                    session = std::make_shared<Session>(id, nullptr);
+                }
+                session->refresh();
+                storage.save(session);
+                if (i % 10 == 0)
+                {
+                    storage.remove(id);
+                }
+            }
+        });
+    }
+    threads.emplace_back([&storage] {
+        for (int i = 0; i < 200; ++i)
+        {
+            storage.removeExpired();
+        }
+    });
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    EXPECT_LE(storage.size(), 400u);
+    storage.removeExpired(nowMillis() + 3601 * 1000);
+    EXPECT_EQ(storage.size(), 0u);
+}
+
+// 带Cookie的请求取回同一会话，清理交给存储的时间轮
+TEST(SessionTest, ManagerGetSession)
+{
+    SessionManager manager(std::make_unique<MemorySessionStorage>());
+    HttpRequest first;
+    HttpResponse firstResp;
+    auto session = manager.getSession(first, &firstResp);
+    ASSERT_NE(session, nullptr);
+    EXPECT_NE(firstResp.getHeader("Set-Cookie").find(session->getId()), std::string::npos);
+
+    HttpRequest second;
+    const std::string cookie = "Cookie: sessionId=" + session->getId() + "; theme=dark";
+    second.addHeader(cookie.data(), cookie.data() + cookie.size());
+    HttpResponse secondResp;
+    EXPECT_EQ(manager.getSession(second, &secondResp), session);
+    EXPECT_EQ(manager.cleanExpiredSessions(), 0u);
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
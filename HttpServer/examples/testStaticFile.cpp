@@ -0,0 +1,314 @@
+#include "./gtest/gtest.h"
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <muduo/net/Buffer.h>
+#include "http/StaticFile.h"
+#include "http/StaticFileCache.h"
+
+using namespace tinyHttp;
+
+// 测试期间存在的临时文件，析构时删除
+class TempFile
+{
+public:
+    TempFile(const std::string &suffix, const std::string &content)
+    {
+        char name[] = "/tmp/tinyhttpXXXXXX";
+        const int fd = ::mkstemp(name);
+        ::close(fd);
+        path_ = std::string(name) + suffix;
+        ::rename(name, path_.c_str());
+        write(content);
+    }
+
+    ~TempFile()
+    {
+        ::unlink(path_.c_str());
+    }
+
+    void write(const std::string &content)
+    {
+        FILE *fp = ::fopen(path_.c_str(), "wb");
+        ::fwrite(content.data(), 1, content.size(), fp);
+        ::fclose(fp);
+    }
+
+    const std::string &path() const { return path_; }
+
+private:
+    std::string path_;
+};
+
+static HttpRequest makeRequest(HttpRequest::Method method, const std::vector<std::string> &headers = {})
+{
+    HttpRequest req;
+    req.setMethod(method);
+    req.setPath(std::string_view("/file"));
+    for (const auto &header : headers)
+    {
+        req.addHeader(header.data(), header.data() + header.size());
+    }
+    return req;
+}
+
+static HttpResponse respond(const std::shared_ptr<StaticFile> &file, const std::vector<std::string> &headers)
+{
+    HttpResponse resp(false);
+    resp.setVersion("HTTP/1.1");
+    StaticFile::respond(makeRequest(HttpRequest::kGet, headers), file, &resp);
+    return resp;
+}
+
+// 单个范围、后缀范围、开放范围，超出文件末尾的结束位置截断到文件末尾
+TEST(StaticFileTest, Ranges)
+{
+    TempFile tmp(".txt", "0123456789");
+    auto file = StaticFile::open(tmp.path());
+    ASSERT_NE(file, nullptr);
+
+    struct Case
+    {
+        std::string range;
+        uint64_t    offset;
+        uint64_t    length;
+        std::string contentRange;
+    };
+    const Case cases[] = {
+        {"bytes=2-4", 2, 3, "bytes 2-4/10"},
+        {"bytes=-3", 7, 3, "bytes 7-9/10"},
+        {"bytes=-100", 0, 10, "bytes 0-9/10"},
+        {"bytes=6-", 6, 4, "bytes 6-9/10"},
+        {"bytes=8-100", 8, 2, "bytes 8-9/10"},
+    };
+    for (const Case &c : cases)
+    {
+        HttpResponse resp = respond(file, {"Range: " + c.range});
+        EXPECT_EQ(resp.getStatusCode(), HttpResponse::k206PartialContent) << c.range;
+        EXPECT_EQ(resp.getHeader("Content-Range"), c.contentRange) << c.range;
+        EXPECT_EQ(resp.getHeader("Content-Length"), std::to_string(c.length)) << c.range;
+        EXPECT_TRUE(resp.isFile());
+        EXPECT_EQ(resp.fileOffset(), c.offset) << c.range;
+        EXPECT_EQ(resp.fileLength(), c.length) << c.range;
+    }
+
+    // 多个范围与无法识别的格式按整个文件返回
+    for (const char *range : {"bytes=0-1,3-4", "bytes=5-2", "items=0-1"})
+    {
+        HttpResponse resp = respond(file, {std::string("Range: ") + range});
+        EXPECT_EQ(resp.getStatusCode(), HttpResponse::k200Ok) << range;
+        EXPECT_EQ(resp.fileLength(), 10u) << range;
+    }
+
+    // If-Range与当前ETag不一致时忽略Range
+    HttpResponse stale = respond(file, {"Range: bytes=2-4", "If-Range: \"other\""});
+    EXPECT_EQ(stale.getStatusCode(), HttpResponse::k200Ok);
+    HttpResponse fresh = respond(file, {"Range: bytes=2-4", "If-Range: " + file->etag()});
+    EXPECT_EQ(fresh.getStatusCode(), HttpResponse::k206PartialContent);
+}
+
+// 起始位置超出文件长度或后缀长度为0时返回416，并给出文件的实际长度
+TEST(StaticFileTest, UnsatisfiableRange)
+{
+    TempFile tmp(".txt", "0123456789");
+    auto file = StaticFile::open(tmp.path());
+    ASSERT_NE(file, nullptr);
+    for (const char *range : {"bytes=10-", "bytes=20-30", "bytes=-0"})
+    {
+        HttpResponse resp = respond(file, {std::string("Range: ") + range});
+        EXPECT_EQ(resp.getStatusCode(), HttpResponse::k416RangeNotSatisfiable) << range;
+        EXPECT_EQ(resp.getHeader("Content-Range"), "bytes */10") << range;
+        EXPECT_EQ(resp.getHeader("Content-Length"), "0") << range;
+        EXPECT_FALSE(resp.isFile());
+    }
+}
+
+// ETag与修改时间的协商缓存，If-None-Match优先于If-Modified-Since
+TEST(StaticFileTest, Revalidation)
+{
+    TempFile tmp(".html", "<p>hello</p>");
+    auto file = StaticFile::open(tmp.path());
+    ASSERT_NE(file, nullptr);
+    const std::string etag = file->etag();
+    const std::string lastModified = file->lastModified();
+
+    HttpResponse full = respond(file, {});
+    EXPECT_EQ(full.getStatusCode(), HttpResponse::k200Ok);
+    EXPECT_EQ(full.getHeader("ETag"), etag);
+    EXPECT_EQ(full.getHeader("Last-Modified"), lastModified);
+    EXPECT_EQ(full.getHeader("Content-Type"), "text/html; charset=utf-8");
+
+    const std::vector<std::string> notModified[] = {
+        {"If-None-Match: " + etag},
+        {"If-None-Match: \"a\", W/" + etag},
+        {"If-None-Match: *"},
+        {"If-Modified-Since: " + lastModified},
+        {"If-Modified-Since: " + StaticFile::httpDate(file->mtime() + 60)},
+    };
+    for (const auto &headers : notModified)
+    {
+        HttpResponse resp = respond(file, headers);
+        EXPECT_EQ(resp.getStatusCode(), HttpResponse::k304NotModified) << headers[0];
+        EXPECT_FALSE(resp.isFile());
+        EXPECT_EQ(resp.getHeader("ETag"), etag);
+    }
+
+    const std::vector<std::string> modified[] = {
+        {"If-None-Match: \"other\""},
+        {"If-Modified-Since: " + StaticFile::httpDate(file->mtime() - 60)},
+        {"If-Modified-Since: not a date"},
+        // If-None-Match不匹配时不再看If-Modified-Since
+        {"If-None-Match: \"other\"", "If-Modified-Since: " + lastModified},
+    };
+    for (const auto &headers : modified)
+    {
+        HttpResponse resp = respond(file, headers);
+        EXPECT_EQ(resp.getStatusCode(), HttpResponse::k200Ok) << headers[0];
+        EXPECT_TRUE(resp.isFile());
+    }
+
+    // HEAD请求只有头部
+    HttpResponse head(false);
+    StaticFile::respond(makeRequest(HttpRequest::kHead), file, &head);
+    EXPECT_EQ(head.getHeader("Content-Length"), "12");
+    EXPECT_FALSE(head.isFile());
+}
+
+static HttpResponse serveCached(StaticFileCache &cache, const std::string &path,
+                                const std::vector<std::string> &headers = {})
+{
+    HttpResponse resp(false);
+    resp.setVersion("HTTP/1.1");
+    cache.serve(makeRequest(HttpRequest::kGet, headers), path, &resp);
+    return resp;
+}
+
+// 缓存响应的头部块中是否包含某一行
+static bool hasRawHeader(const HttpResponse &resp, const std::string &line)
+{
+    muduo::net::Buffer buf;
+    resp.appendHeadToBuffer(&buf);
+    return buf.retrieveAllAsString().find("\r\n" + line + "\r\n") != std::string::npos;
+}
+
+static std::string inflate(std::string_view data, int windowBits)
+{
+    z_stream zs = {};
+    inflateInit2(&zs, windowBits);
+    std::string out(64 * 1024, '\0');
+    zs.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+    zs.avail_in = static_cast<uInt>(data.size());
+    zs.next_out = reinterpret_cast<Bytef *>(&out[0]);
+    zs.avail_out = static_cast<uInt>(out.size());
+    const int ret = ::inflate(&zs, Z_FINISH);
+    out.resize(ret == Z_STREAM_END ? zs.total_out : 0);
+    inflateEnd(&zs);
+    return out;
+}
+
+// 命中缓存时响应体直接引用缓存内容；可压缩类型按Accept-Encoding返回gzip或deflate版本，各版本ETag不同
+TEST(StaticFileCacheTest, CompressedVariants)
+{
+    std::string content;
+    for (int i = 0; i < 200; ++i)
+    {
+        content += "line " + std::to_string(i) + " of a compressible text file\n";
+    }
+    TempFile tmp(".txt", content);
+    StaticFileCache cache;
+
+    HttpResponse identity = serveCached(cache, tmp.path());
+    EXPECT_EQ(identity.getStatusCode(), HttpResponse::k200Ok);
+    EXPECT_EQ(identity.body(), content);
+    EXPECT_TRUE(hasRawHeader(identity, "Content-Length: " + std::to_string(content.size())));
+    EXPECT_TRUE(hasRawHeader(identity, "Vary: Accept-Encoding"));
+    EXPECT_EQ(cache.size(), 1u);
+
+    HttpResponse gzip = serveCached(cache, tmp.path(), {"Accept-Encoding: gzip, deflate"});
+    EXPECT_TRUE(hasRawHeader(gzip, "Content-Encoding: gzip"));
+    EXPECT_LT(gzip.body().size(), content.size());
+    EXPECT_EQ(inflate(gzip.body(), 15 + 16), content);
+
+    HttpResponse deflate = serveCached(cache, tmp.path(), {"Accept-Encoding: deflate"});
+    EXPECT_TRUE(hasRawHeader(deflate, "Content-Encoding: deflate"));
+    EXPECT_EQ(inflate(deflate.body(), 15), content);
+
+    // 同一个文件只有一个缓存项，压缩版本共用
+    EXPECT_EQ(cache.size(), 1u);
+    EXPECT_EQ(serveCached(cache, tmp.path()).body().data(), identity.body().data());
+
+    // 协商缓存按所选版本的ETag比较
+    auto file = StaticFile::open(tmp.path());
+    const std::string etag = file->etag();
+    const std::string gzipEtag = etag.substr(0, etag.size() - 1) + "-gzip\"";
+    EXPECT_EQ(serveCached(cache, tmp.path(), {"Accept-Encoding: gzip", "If-None-Match: " + gzipEtag}).getStatusCode(),
+              HttpResponse::k304NotModified);
+    EXPECT_EQ(serveCached(cache, tmp.path(), {"If-None-Match: " + gzipEtag}).getStatusCode(), HttpResponse::k200Ok);
+    EXPECT_EQ(serveCached(cache, tmp.path(), {"If-None-Match: " + etag}).getStatusCode(),
+              HttpResponse::k304NotModified);
+
+    // 小文件与不可压缩类型只有原始版本
+    TempFile small(".txt", "short");
+    EXPECT_FALSE(hasRawHeader(serveCached(cache, small.path(), {"Accept-Encoding: gzip"}), "Content-Encoding: gzip"));
+    TempFile image(".png", std::string(4096, 'a'));
+    EXPECT_FALSE(hasRawHeader(serveCached(cache, image.path(), {"Accept-Encoding: gzip"}), "Content-Encoding: gzip"));
+}
+
+// 超出字节上限时淘汰最久未使用的缓存项：被淘汰的文件删除后不再能从缓存中取得
+TEST(StaticFileCacheTest, LruEviction)
+{
+    TempFile a(".png", std::string(1000, 'a'));
+    TempFile b(".png", std::string(1000, 'b'));
+    TempFile c(".png", std::string(1000, 'c'));
+    StaticFileCache cache(2800, StaticFileCache::kDefaultMaxEntrySize, 3600);
+
+    serveCached(cache, a.path());
+    serveCached(cache, b.path());
+    EXPECT_EQ(cache.size(), 2u);
+    serveCached(cache, a.path()); // a变为最近使用
+    serveCached(cache, c.path());
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_LE(cache.bytes(), 2800u);
+
+    ::unlink(a.path().c_str());
+    ::unlink(b.path().c_str());
+    EXPECT_EQ(serveCached(cache, a.path()).body(), std::string(1000, 'a'));
+    EXPECT_EQ(serveCached(cache, b.path()).getStatusCode(), HttpResponse::k404NotFound);
+
+    cache.invalidate(c.path());
+    EXPECT_EQ(cache.size(), 1u);
+    cache.clear();
+    EXPECT_EQ(cache.size(), 0u);
+    EXPECT_EQ(cache.bytes(), 0u);
+}
+
+// 缓存期间文件被截断：重新检查前继续返回缓存的完整副本，不会因访问超出文件末尾的映射而崩溃；
+// 重新检查后返回新的内容
+TEST(StaticFileCacheTest, TruncatedFile)
+{
+    const std::string content(64 * 1024, 'x');
+    TempFile tmp(".bin", content);
+    StaticFileCache cache(StaticFileCache::kDefaultMaxBytes, StaticFileCache::kDefaultMaxEntrySize, 3600);
+    StaticFileCache revalidating(StaticFileCache::kDefaultMaxBytes, StaticFileCache::kDefaultMaxEntrySize, 0);
+    HttpResponse first = serveCached(cache, tmp.path());
+    serveCached(revalidating, tmp.path());
+
+    ASSERT_EQ(::truncate(tmp.path().c_str(), 0), 0);
+    HttpResponse second = serveCached(cache, tmp.path());
+    EXPECT_EQ(second.body(), content);
+    EXPECT_EQ(first.body(), content);
+
+    tmp.write("new");
+    EXPECT_EQ(serveCached(revalidating, tmp.path()).body(), "new");
+}
+
+int main(int argc, char **argv)
+{
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace tinyHttp
+{
+    // 请求头块扫描器
+    // 一次扫描同时找出每行的CRLF与该行第一个':'的位置，解析请求头时直接按索引切分，不再重复扫描
+    // x86平台使用SSE2/AVX2按16/32字节批量比较，其他平台退化为逐字节扫描
+    class HeaderScanner
+    {
+    public:
+        // 单行请求头的索引，均为相对于请求头块起始位置的偏移
+        struct Line
+        {
+            uint32_t begin; // 行首
+            uint32_t colon; // 第一个':'的位置，不存在时等于end
+            uint32_t end;   // 行尾CRLF中'\r'的位置
+        };
+
+        HeaderScanner()
+        : scanned_(0)
+        , lineBegin_(0)
+        , colon_(kNoColon)
+        , blockSize_(0)
+        {
+
+        }
+
+        // 从上次停止的位置继续扫描[data, data + len)，data必须始终指向请求头块的起始位置
+        // 遇到空行（请求头结束）返回true
+        bool scan(const char* data, size_t len);
+
+        bool done() const
+        { return blockSize_ != 0; }
+
+        // 已索引的请求头行
+        const std::vector<Line>& lines() const
+        { return lines_; }
+
+        // 请求头块的总长度，包括结尾的空行
+        size_t blockSize() const
+        { return blockSize_; }
+
+        // 已扫描的字节数，用于限制请求头大小，请求头结束后等于blockSize()
+        size_t scannedBytes() const
+        { return scanned_; }
+
+        // 清空索引，保留已分配的容量
+        void reset()
+        {
+            lines_.clear();
+            scanned_ = 0;
+            lineBegin_ = 0;
+            colon_ = kNoColon;
+            blockSize_ = 0;
+        }
+
+    private:
+        static constexpr uint32_t kNoColon = UINT32_MAX;
+
+        // 处理位于pos的'\r'或':'，返回false表示需要等待更多数据或已找到空行
+        bool onDelimiter(const char* data, size_t len, size_t pos);
+
+        // 各指令集版本的扫描实现，返回false表示扫描已停止
+        bool scanScalar(const char* data, size_t len);
+#if defined(__SSE2__)
+        bool scanSse2(const char* data, size_t len);
+#endif
+#if defined(__x86_64__) && defined(__GNUC__)
+        bool scanAvx2(const char* data, size_t len);
+#endif
+
+        std::vector<Line> lines_;
+        size_t            scanned_;   // 下一次扫描的起始偏移
+        uint32_t          lineBegin_; // 当前行的起始偏移
+        uint32_t          colon_;     // 当前行第一个':'的偏移
+        size_t            blockSize_; // 找到空行后记录请求头块长度
+    };
+}
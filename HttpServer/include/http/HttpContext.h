@@ -1,7 +1,10 @@
 #pragma once
 
+#include <functional>
+
 #include <muduo/net/TcpServer.h>
 #include <muduo/base/Logging.h>
+#include "HeaderScanner.h"
 #include "HttpRequest.h"
 
 
@@ -10,23 +13,88 @@ namespace tinyHttp
     class HttpContext
     {
     public:
-        HttpContext()
-        : complete_(false)
+        // 解析状态，报文可能分多个TCP分段到达，每次从上次停下的状态继续解析
+        enum HttpRequestParseState
+        {
+            kExpectRequestLine, // 等待请求行
+            kExpectHeaders,     // 等待请求头
+            kExpectBody,        // 等待请求体（Content-Length）
+            kExpectChunkSize,   // 等待块大小行（chunked）
+            kExpectChunkData,   // 等待块数据
+            kExpectChunkCRLF,   // 等待块数据后的CRLF
+            kExpectTrailers,    // 等待最后一块之后的trailer头部
+            kGotAll,            // 解析完成
+        };
+
+        // 请求体默认最大长度，Content-Length与chunked两种方式都受此限制
+        static constexpr uint64_t kDefaultMaxBodySize = 8 * 1024 * 1024;
+
+        // 流式请求体的接收函数，返回实际消费的字节数
+        // 返回值小于len表示暂时无法继续接收，剩余数据留在输入缓冲区，解析暂停直到下一次parseRequest
+        using BodySink = std::function<size_t(const HttpRequest&, const char* data, size_t len)>;
+        // 请求头解析完成、开始读取请求体之前调用，可在其中通过setBodySink开启流式接收
+        using HeadersCallback = std::function<void(HttpContext*)>;
+        // sink暂停接收后由连接调用，sink能够继续接收时在任意线程调用一次resume，连接随即重新交付剩余的请求体
+        using ResumeCallback = std::function<void()>;
+        using PauseCallback = std::function<void(const HttpRequest&, ResumeCallback resume)>;
+
+        explicit HttpContext(uint64_t maxBodySize = kDefaultMaxBodySize)
+        : state_(kExpectRequestLine)
+        , scanned_(0)
+        , chunkRemaining_(0)
+        , bodyReceived_(0)
+        , trailerBytes_(0)
+        , maxBodySize_(maxBodySize)
+        , bodyLimit_(maxBodySize)
+        , bodyPaused_(false)
         {
 
         }
 
-        // 解析HTTP请求
+        // 解析HTTP请求，数据不完整时保存解析进度并返回true，等待下一批数据到达后再次调用
+        // 返回false表示报文格式错误，通过parseComplete()判断是否已解析出完整请求
         bool parseRequest(muduo::net::Buffer* buf, muduo::Timestamp receiveTime);
 
         bool parseComplete() const
-        { return complete_ == true;  }
+        { return state_ == kGotAll;  }
+
+        HttpRequestParseState state() const
+        { return state_; }
+
+        void setHeadersCallback(HeadersCallback cb)
+        { headersCallback_ = std::move(cb); }
 
+        // 当前请求的请求体改为边到达边交给sink，不再缓存在HttpRequest中，maxBodySize替代连接的请求体上限
+        // sink可能返回小于len的值时必须提供onPause，否则暂停后无人通知连接恢复；只能在HeadersCallback中调用
+        void setBodySink(BodySink sink, uint64_t maxBodySize, PauseCallback onPause = nullptr)
+        {
+            bodySink_ = std::move(sink);
+            pauseCallback_ = std::move(onPause);
+            bodyLimit_ = maxBodySize;
+            request_.setBodyStreamed(true);
+        }
+
+        const PauseCallback& pauseCallback() const
+        { return pauseCallback_; }
+
+        // 流式接收是否因sink未能消费全部数据而暂停
+        bool bodyPaused() const
+        { return bodyPaused_; }
+
+        // 准备解析同一连接上的下一个请求，请求对象原地清空并保留已分配的容量
         void reset()
         {
-            complete_ = false;
-            HttpRequest dummyData;
-            request_.swap(dummyData);
+            state_ = kExpectRequestLine;
+            scanned_ = 0;
+            chunkRemaining_ = 0;
+            bodyReceived_ = 0;
+            trailerBytes_ = 0;
+            bodyLimit_ = maxBodySize_;
+            bodySink_ = nullptr;
+            pauseCallback_ = nullptr;
+            bodyPaused_ = false;
+            headerScanner_.reset();
+            request_.clear();
         }
 
         const HttpRequest& request() const
@@ -41,14 +109,41 @@ namespace tinyHttp
         }
 
     private:
+        // 从上次扫描停止的位置继续查找CRLF，避免重复扫描已检查过的字节
+        const char* findCRLF(const muduo::net::Buffer* buf);
         // 解析请求行
         bool processRequestLine(const char* begin, const char* end);
-        // 解析请求头
-        bool processHeaders(const char* begin, const char* end);
-        // 解析请求体
-        bool processBody(const char* begin, const char* end);
+        // 按扫描索引解析整个请求头块
+        bool processHeaders(const char* block);
+        // 请求头解析完成后确定请求体的读取方式
+        bool beginBody();
+        // Transfer-Encoding的最后一个编码是否为chunked
+        static bool isChunked(std::string_view encoding);
+        // 解析chunked编码的块大小行
+        bool processChunkSize(const char* begin, const char* end);
+        // 将请求体数据追加到请求或交给流式sink，返回本次消费的字节数
+        size_t deliverBody(const char* data, size_t len);
+
+        // 请求头块（不含请求行）的最大长度，chunked请求的trailer合计也受此限制
+        static constexpr size_t kMaxHeaderSize = 64 * 1024;
+        // 请求行的最大长度，等不到CRLF时缓冲区不会无限增长
+        static constexpr size_t kMaxRequestLineSize = 8 * 1024;
+        // chunked块大小行的最大长度（包括块扩展）
+        static constexpr size_t kMaxChunkLineSize = 1024;
 
-        bool complete_;
-        HttpRequest request_;
+        HttpRequestParseState state_;
+        // 当前行中已扫描且确认不含CRLF的字节数（相对于buf->peek()）
+        size_t                scanned_;
+        uint64_t              chunkRemaining_; // 当前块剩余未读取的字节数
+        uint64_t              bodyReceived_;   // 当前请求已接收的请求体字节数
+        size_t                trailerBytes_;   // 当前请求已接收的trailer字节数
+        uint64_t              maxBodySize_;
+        uint64_t              bodyLimit_;      // 当前请求的请求体上限
+        bool                  bodyPaused_;
+        HeadersCallback       headersCallback_;
+        BodySink              bodySink_;
+        PauseCallback         pauseCallback_;
+        HeaderScanner         headerScanner_;
+        HttpRequest           request_;
     };
-}
\ No newline at end of file
+}
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace tinyHttp
+{
+    // 预先编号的常用头部字段，查找时直接按编号定位，无需比较字符串
+    enum class HeaderId : uint8_t
+    {
+        kUnknown,
+        kHost,
+        kContentLength,
+        kContentType,
+        kConnection,
+        kCookie,
+        kSetCookie,
+        kTransferEncoding,
+        kAcceptEncoding,
+        kContentEncoding,
+        kUserAgent,
+        kAccept,
+        kCacheControl,
+        kIfModifiedSince,
+        kIfNoneMatch,
+        kRange,
+        kCount
+    };
+
+    // 扁平的HTTP头部容器
+    // 头部字段名、值连续存放在同一块缓冲区中，条目本身按顺序存放在内联数组里（常见请求不超过16个头部，不需要堆分配），
+    // 超出部分才放入vector；字段名按ASCII大小写不敏感比较，常用字段通过HeaderId O(1)定位
+    class HttpHeaders
+    {
+    public:
+        static constexpr size_t kInlineCapacity = 16;
+
+        // ASCII大小写不敏感的FNV-1a哈希，可在编译期求值
+        static constexpr uint32_t hash(std::string_view name)
+        {
+            uint32_t h = 2166136261u;
+            for (char c : name)
+            {
+                if (c >= 'A' && c <= 'Z')
+                {
+                    c = static_cast<char>(c - 'A' + 'a');
+                }
+                h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+            }
+            return h;
+        }
+
+        // ASCII大小写不敏感的相等比较
+        static bool equalsIgnoreCase(std::string_view a, std::string_view b);
+
+        // 根据字段名获取常用字段编号，非常用字段返回kUnknown
+        static HeaderId idOf(std::string_view name) { return idOf(name, hash(name)); }
+
+        HttpHeaders()
+        : size_(0)
+        {
+            known_.fill(0);
+        }
+
+        // 将原始请求头块整体拷贝进缓冲区，返回拷贝后的起始地址，之后以该范围内的指针调用add()不再拷贝
+        const char* appendRaw(const char* start, const char* end);
+
+        // 追加一个头部字段，允许同名字段重复出现，返回字段编号
+        HeaderId add(std::string_view name, std::string_view value);
+        // 设置头部字段，已存在时覆盖其值
+        void set(std::string_view name, std::string_view value);
+        // 删除所有同名字段
+        void remove(std::string_view name);
+
+        // 获取字段值，同名字段重复出现时返回最后一个，不存在时返回空视图
+        std::string_view get(std::string_view name) const;
+        std::string_view get(HeaderId id) const;
+
+        bool has(std::string_view name) const { return find(name, hash(name)) != kNotFound; }
+        bool has(HeaderId id) const { return known_[static_cast<size_t>(id)] != 0; }
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+
+        // 按插入顺序访问第i个字段
+        std::string_view name(size_t i) const { return view(entry(i).name); }
+        std::string_view value(size_t i) const { return view(entry(i).value); }
+        HeaderId id(size_t i) const { return entry(i).id; }
+
+        // 遍历所有字段，func(std::string_view name, std::string_view value)
+        template <typename Func>
+        void forEach(Func&& func) const
+        {
+            for (size_t i = 0; i < size_; ++i)
+            {
+                func(name(i), value(i));
+            }
+        }
+
+        // 清空所有字段，保留缓冲区与条目数组已分配的容量
+        void clear();
+
+        void swap(HttpHeaders& that) noexcept;
+
+    private:
+        static constexpr size_t kNotFound = SIZE_MAX;
+
+        struct Slice
+        {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+
+        struct Entry
+        {
+            Slice    name;
+            Slice    value;
+            uint32_t hash = 0;
+            HeaderId id = HeaderId::kUnknown;
+        };
+
+        static HeaderId idOf(std::string_view name, uint32_t hash);
+
+        std::string_view view(Slice slice) const
+        { return std::string_view(buf_.data() + slice.offset, slice.length); }
+
+        Entry& entry(size_t i)
+        { return i < kInlineCapacity ? inline_[i] : overflow_[i - kInlineCapacity]; }
+        const Entry& entry(size_t i) const
+        { return i < kInlineCapacity ? inline_[i] : overflow_[i - kInlineCapacity]; }
+
+        // 数据是否位于buf_中
+        bool contains(std::string_view data) const;
+        // 若数据已位于buf_中则直接记录偏移，否则追加到buf_末尾
+        Slice store(std::string_view data);
+        // 从后向前查找同名字段的下标
+        size_t find(std::string_view name, uint32_t hash) const;
+        // 重建常用字段的下标索引
+        void reindex();
+
+        std::string                                        buf_;
+        std::array<Entry, kInlineCapacity>                 inline_;
+        std::vector<Entry>                                 overflow_;
+        size_t                                             size_;
+        // 常用字段最后一次出现的下标+1，0表示不存在
+        std::array<uint32_t, static_cast<size_t>(HeaderId::kCount)> known_;
+    };
+}
@@ -1,12 +1,13 @@
 #pragma once
 
-#include <map>
+#include <algorithm>
 #include <string>
-#include <unordered_map>
 #include <muduo/base/Timestamp.h>
-#include <regex>
+#include <string_view>
 #include <utility>
+#include <vector>
 #include <nlohmann/json.hpp>
+#include "HttpHeaders.h"
 
 namespace tinyHttp
 {
@@ -22,13 +23,6 @@ namespace tinyHttp
         // 构造函数初始化成员变量
         HttpRequest()
             : method_(kInvalid)
-            , version_("Unknown")
-            , selfCheckFunc_({
-                {kGet,   [this] { return checkGetLikeMethod(); }},
-                {kPost,   [this] { return checkPostLikeMethod(); }},
-                {kPut,    [this] { return checkPostLikeMethod(); }},
-                {kDelete, [this] { return checkGetLikeMethod(); }}
-            })
         {
 
         }
@@ -39,6 +33,46 @@ namespace tinyHttp
         // 获取私有成员 receiveTime_
         muduo::Timestamp receiveTime() const { return receiveTime_; }
 
+        // 编译期可求值的请求方法解析，先按长度分派再比较字面量，无需构造查找表
+        static constexpr Method parseMethod(std::string_view method)
+        {
+            switch (method.size())
+            {
+            case 3:
+                if (method == "GET") return kGet;
+                if (method == "PUT") return kPut;
+                break;
+            case 4:
+                if (method == "POST") return kPost;
+                if (method == "HEAD") return kHead;
+                break;
+            case 6:
+                if (method == "DELETE") return kDelete;
+                break;
+            case 7:
+                if (method == "OPTIONS") return kOptions;
+                break;
+            default:
+                break;
+            }
+            return kInvalid;
+        }
+
+        // parseMethod的逆过程，kInvalid返回"UNKNOWN"
+        static constexpr std::string_view methodString(Method method)
+        {
+            switch (method)
+            {
+            case kGet:     return "GET";
+            case kPost:    return "POST";
+            case kHead:    return "HEAD";
+            case kPut:     return "PUT";
+            case kDelete:  return "DELETE";
+            case kOptions: return "OPTIONS";
+            default:       return "UNKNOWN";
+            }
+        }
+
         // 设置和获取请求方法
         bool setMethod(const char* start, const char* end);
         bool setMethod(Method method);
@@ -46,49 +80,77 @@ namespace tinyHttp
         // 获取请求方法私有变量
         Method method() const { return method_; }
 
+        // 将原始请求行整体拷贝进请求自身的连续存储区，返回拷贝后的起始地址
+        // 之后以该地址范围调用的setter只记录偏移，不再产生拷贝
+        const char* appendRaw(const char* start, const char* end);
+
+        // 将原始请求头块整体拷贝进头部容器，返回拷贝后的起始地址，随后以该范围调用addHeader不再拷贝
+        const char* appendRawHeaders(const char* start, const char* end)
+        { return headers_.appendRaw(start, end); }
+
         // 设置和获取请求路径
         void setPath(const char* start, const char* end);
 
-        void setPath(const std::string& path)
+        void setPath(std::string_view path)
         {
-            path_ = path;
+            setPath(path.data(), path.data() + path.size());
         }
 
-        // 获取请求路径私有变量
-        std::string path() const { return path_; }
+        // 获取请求路径，返回的视图在请求被修改或重置前有效
+        std::string_view path() const { return view(path_); }
 
         // 设置和获取路径参数
-        void setPathParameters(const std::string &key, const std::string &value);
+        void setPathParameters(std::string_view key, std::string_view value);
 
         /// 获取路径参数
-        std::string getPathParameters(const std::string &key) const;
+        std::string_view getPathParameters(std::string_view key) const;
+
+        // 清空路径参数，同一请求重新路由前调用
+        void clearPathParameters()
+        { pathParameters_.clear(); }
 
         // 设置和获取查询参数
         void setQueryParameters(const char* start, const char* end);
 
         // 获取查询参数
-        std::string getQueryParameters(const std::string &key) const;
+        std::string_view getQueryParameters(std::string_view key) const;
+
+        // 按出现顺序遍历查询参数
+        size_t queryParameterCount() const
+        { return queryParameters_.size(); }
+        std::pair<std::string_view, std::string_view> queryParameter(size_t index) const
+        { return {view(queryParameters_[index].first), view(queryParameters_[index].second)}; }
 
         // 设置HTTP版本
-        void setVersion(std::string v)
+        void setVersion(std::string_view v)
         {
-            version_ = std::move(v);
+            version_ = store(v.data(), v.data() + v.size());
         }
 
         // 获取版本
-        std::string getVersion() const
+        std::string_view getVersion() const
         {
-            return version_;
+            return version_.length == 0 ? std::string_view("Unknown") : view(version_);
         }
 
         // 设置和获取请求头 每次接收一行请求头调用一次
-        void addHeader(const char* start, const char* end);
-        // 获取请求头，根据字段名获取对应值
-        std::string getHeader(const std::string& field) const;
+        // 返回false表示头部行格式错误，或Content-Length无法解析、与之前的取值冲突
+        bool addHeader(const char* start, const char* end);
+        // 已知第一个':'位置时直接切分，无需再次查找
+        bool addHeader(const char* start, const char* colon, const char* end);
+        // 获取请求头，根据字段名获取对应值，字段名大小写不敏感
+        std::string_view getHeader(std::string_view field) const
+        { return headers_.get(field); }
+        // 常用字段按编号O(1)获取
+        std::string_view getHeader(HeaderId id) const
+        { return headers_.get(id); }
         // 获取所有请求头
-        const std::map<std::string, std::string>& headers() const
+        const HttpHeaders& headers() const
         { return headers_; }
 
+        // 客户端是否通过Accept-Encoding接受某种内容编码，"*"匹配任意编码，q=0表示拒绝
+        bool acceptsEncoding(std::string_view coding) const;
+
         // 设置请求体
         void setBody(const std::string& body) { content_ = body; }
         // 通过头尾指针设置请求体
@@ -100,40 +162,91 @@ namespace tinyHttp
             }
         }
 
+        // 追加请求体，请求体分多个TCP分段到达时逐段追加
+        void appendBody(const char* start, const char* end)
+        {
+            if (content_.empty())
+            {
+                // 首段到达时按Content-Length预留空间（上限1MB，防止伪造的超大长度），避免多次扩容拷贝
+                content_.reserve(std::min<uint64_t>(contentLength_, 1024 * 1024));
+            }
+            content_.append(start, end);
+        }
+
         // 获取请求体
-        std::string getBody() const
+        std::string_view getBody() const
         { return content_; }
 
+        // 获取已接收的请求体长度
+        size_t bodySize() const
+        { return content_.size(); }
+
         // 设置和获取请求体长度
         void setContentLength(uint64_t length)
         { contentLength_ = length; }
         uint64_t contentLength() const
         { return contentLength_; }
 
+        // 客户端IP地址，属于连接级信息，由服务器在连接建立时设置，clear()时保留
+        void setPeerAddress(std::string address)
+        { peerAddress_ = std::move(address); }
+        const std::string& peerAddress() const
+        { return peerAddress_; }
+
+        // 请求体是否以流式方式交给了路由处理器，此时getBody()为空
+        void setBodyStreamed(bool streamed)
+        { bodyStreamed_ = streamed; }
+        bool bodyStreamed() const
+        { return bodyStreamed_; }
+
         // 交换所有成员
         void swap(HttpRequest& that) noexcept;
 
+        // 清空所有字段以便复用于同一连接上的下一个请求，保留各缓冲区已分配的容量
+        void clear();
+
         // 将所有成员通过json格式打印在控制台中
         void showDetails() const;
 
-        // 进行自检验
-        bool selfCheck() const;
+        // 进行自检验，按请求方法分派到对应的检查函数
+        bool selfCheck();
 
     private:
-        std::unordered_map<Method, std::function<bool()>> selfCheckFunc_;
+        // 字段在arena_中的位置，用偏移而非指针表示，arena_扩容或请求被拷贝后依然有效
+        struct Slice
+        {
+            uint32_t offset = 0;
+            uint32_t length = 0;
+        };
+        using SlicePair = std::pair<Slice, Slice>;
+
+        std::string_view view(Slice slice) const
+        { return std::string_view(arena_.data() + slice.offset, slice.length); }
+
+        // 若[start, end)已位于arena_中则直接记录偏移，否则追加到arena_末尾
+        Slice store(const char* start, const char* end);
+
+        // clear()时请求体缓冲区最多保留的容量，超过则释放，避免一次大上传长期占用连接内存
+        static constexpr size_t kMaxRetainedBodyCapacity = 64 * 1024;
+
+        // 在键值对列表中查找，后出现的同名字段覆盖先出现的
+        std::string_view find(const std::vector<SlicePair>& pairs, std::string_view key) const;
 
         bool checkGetLikeMethod() const;
 
         bool checkPostLikeMethod();
 
         Method                                       method_; // 请求方法
-        std::string                                  version_; // http版本
-        std::string                                  path_; // 请求路径
-        std::unordered_map<std::string, std::string> pathParameters_; // 路径参数
-        std::unordered_map<std::string, std::string> queryParameters_; // 查询参数
+        std::string                                  arena_; // 请求行、请求头、参数的连续存储区
+        Slice                                        version_; // http版本
+        Slice                                        path_; // 请求路径
+        std::vector<SlicePair>                       pathParameters_; // 路径参数
+        std::vector<SlicePair>                       queryParameters_; // 查询参数
         muduo::Timestamp                             receiveTime_; // 接收时间
-        std::map<std::string, std::string>           headers_; // 请求头
+        HttpHeaders                                  headers_; // 请求头
         std::string                                  content_; // 请求体
         uint64_t                                     contentLength_ { 0 }; // 请求体长度
+        bool                                         bodyStreamed_ { false }; // 请求体是否已流式交付
+        std::string                                  peerAddress_; // 客户端IP地址
     };
-}
\ No newline at end of file
+}
@@ -1,10 +1,17 @@
 #pragma once
 
+#include <charconv>
+#include <memory>
+#include <string_view>
+
 #include <muduo/net/TcpServer.h>
+#include "HttpHeaders.h"
 
 
 namespace tinyHttp
 {
+    class StaticFile;
+
     class HttpResponse
     {
     public:
@@ -13,30 +20,75 @@ namespace tinyHttp
             kUnknown,
             k200Ok = 200,
             k204NoContent = 204,
+            k206PartialContent = 206,
             k301MovedPermanently = 301,
+            k304NotModified = 304,
             k400BadRequest = 400,
             k401Unauthorized = 401,
             k403Forbidden = 403,
             k404NotFound = 404,
             k409Conflict = 409,
+            k416RangeNotSatisfiable = 416,
+            k429TooManyRequests = 429,
             k500InternalServerError = 500,
         };
 
+        // 状态码对应的标准原因短语，编译期可求值，未收录的状态码返回空
+        static constexpr std::string_view reasonPhrase(HttpStatusCode code)
+        {
+            switch (code)
+            {
+            case k200Ok:                  return "OK";
+            case k204NoContent:           return "No Content";
+            case k206PartialContent:      return "Partial Content";
+            case k301MovedPermanently:    return "Moved Permanently";
+            case k304NotModified:         return "Not Modified";
+            case k400BadRequest:          return "Bad Request";
+            case k401Unauthorized:        return "Unauthorized";
+            case k403Forbidden:           return "Forbidden";
+            case k404NotFound:            return "Not Found";
+            case k409Conflict:            return "Conflict";
+            case k416RangeNotSatisfiable: return "Range Not Satisfiable";
+            case k429TooManyRequests:     return "Too Many Requests";
+            case k500InternalServerError: return "Internal Server Error";
+            default:                      return "";
+            }
+        }
+
         HttpResponse(bool close = true)
             : statusCode_(kUnknown)
             , closeConnection_(close)
+            , isFile_(false)
+            , fileOffset_(0)
+            , fileLength_(0)
         {}
 
         void setVersion(std::string version)
         { httpVersion_ = version; }
+        const std::string& version() const
+        { return httpVersion_; }
         void setStatusCode(HttpStatusCode code)
         { statusCode_ = code; }
 
         HttpStatusCode getStatusCode() const
         { return statusCode_; }
 
-        void setStatusMessage(const std::string message)
-        { statusMessage_ = message; }
+        // 与标准原因短语相同的状态消息不单独保存，序列化时直接取常量表
+        void setStatusMessage(std::string_view message)
+        {
+            if (message == reasonPhrase(statusCode_))
+            {
+                statusMessage_.clear();
+            }
+            else
+            {
+                statusMessage_.assign(message.data(), message.size());
+            }
+        }
+
+        // 状态消息，未设置时为标准原因短语
+        std::string_view statusMessage() const
+        { return statusMessage_.empty() ? reasonPhrase(statusCode_) : std::string_view(statusMessage_); }
 
         void setCloseConnection(bool on)
         { closeConnection_ = on; }
@@ -44,41 +96,175 @@ namespace tinyHttp
         bool closeConnection() const
         { return closeConnection_; }
 
-        void setContentType(const std::string& contentType)
+        void setContentType(std::string_view contentType)
         { addHeader("Content-Type", contentType); }
 
         void setContentLength(uint64_t length)
-        { addHeader("Content-Length", std::to_string(length)); }
+        {
+            char buf[24];
+            const auto result = std::to_chars(buf, buf + sizeof buf, length);
+            addHeader("Content-Length", std::string_view(buf, result.ptr - buf));
+        }
 
-        void addHeader(const std::string& key, const std::string& value)
-        { headers_[key] = value; }
+        // 设置响应头，字段名大小写不敏感，重复设置时覆盖
+        // Connection头部不保存，而是更新closeConnection_，序列化时始终只输出一个与连接实际行为一致的Connection头部
+        void addHeader(std::string_view key, std::string_view value)
+        {
+            if (HttpHeaders::idOf(key) == HeaderId::kConnection)
+            {
+                closeConnection_ = HttpHeaders::equalsIgnoreCase(value, "close");
+                return;
+            }
+            headers_.set(key, value);
+        }
+
+        std::string_view getHeader(std::string_view key) const
+        { return headers_.get(key); }
+        std::string_view getHeader(HeaderId id) const
+        { return headers_.get(id); }
+
+        const HttpHeaders& headers() const
+        { return headers_; }
 
         void setBody(const std::string& body)
         {
             body_ = body;
-            // body_ += "\0";
+            sharedBody_.reset();
+            serialized_.reset();
+            clearFile();
+        }
+
+        void setBody(std::string&& body)
+        {
+            body_ = std::move(body);
+            sharedBody_.reset();
+            serialized_.reset();
+            clearFile();
+        }
+
+        // 设置共享的响应体，缓存或预渲染的内容可被多个响应引用，不产生拷贝
+        void setBody(std::shared_ptr<const std::string> body)
+        {
+            const size_t length = body ? body->size() : 0;
+            const char* data = body ? body->data() : nullptr;
+            setBody(std::shared_ptr<const char>(std::move(body), data), length);
+        }
+
+        // data的所有者（如缓存的文件内容）由shared_ptr的别名构造保持存活
+        void setBody(std::shared_ptr<const char> data, size_t length)
+        {
+            sharedBody_ = std::move(data);
+            sharedLength_ = sharedBody_ ? length : 0;
+            body_.clear();
+            serialized_.reset();
+            clearFile();
+        }
+
+        // 以文件的[offset, offset + length)作为响应体，由服务器在连接可写时分片读取并发送
+        // Content-Length等头部由调用者设置，一般通过StaticFile::respond完成
+        void setFile(std::shared_ptr<const StaticFile> file, uint64_t offset, uint64_t length)
+        {
+            file_ = std::move(file);
+            fileOffset_ = offset;
+            fileLength_ = length;
+            isFile_ = true;
+            body_.clear();
+            sharedBody_.reset();
+            serialized_.reset();
         }
 
+        bool isFile() const
+        { return isFile_; }
+        const std::shared_ptr<const StaticFile>& file() const
+        { return file_; }
+        uint64_t fileOffset() const
+        { return fileOffset_; }
+        uint64_t fileLength() const
+        { return fileLength_; }
+
+        std::string_view body() const
+        { return sharedBody_ ? std::string_view(sharedBody_.get(), sharedLength_) : std::string_view(body_); }
+
+        // 设置预先序列化好的头部块（每行以CRLF结尾），序列化时原样写在其他头部之后，
+        // 用于缓存的响应，避免每次请求重新格式化头部
+        void setRawHeaders(std::shared_ptr<const std::string> block)
+        { rawHeaders_ = std::move(block); }
+
+        bool hasRawHeaders() const
+        { return rawHeaders_ && !rawHeaders_->empty(); }
+
+        // 以完整序列化好的响应字节（状态行、头部与响应体）作为输出，用于响应缓存命中
+        // bytes中必须包含"Connection: Keep-Alive"头部且位于connectionOffset处：长连接时整块原样追加，
+        // 需要关闭连接时只替换这一行；其他头部与响应体的设置被忽略
+        void setSerialized(std::shared_ptr<const std::string> bytes, size_t connectionOffset)
+        {
+            serialized_ = std::move(bytes);
+            serializedConnection_ = connectionOffset;
+            body_.clear();
+            sharedBody_.reset();
+            clearFile();
+        }
+
+        bool isSerialized() const
+        { return serialized_ != nullptr; }
+
+        // 以长连接形式序列化整个响应，返回的字节与Connection头部的位置可直接用于setSerialized
+        std::string serialize(size_t* connectionOffset);
+
         void setStatusLine(const std::string& version,
                              HttpStatusCode statusCode,
-                             const std::string& statusMessage);
+                             std::string_view statusMessage);
 
         void setErrorHeader(){}
 
+        // 状态行与头部（包括结尾空行）序列化后的长度
+        size_t headSize() const;
+
+        // 序列化后的响应长度（状态行、头部与响应体）
+        size_t serializedSize() const
+        { return serialized_ ? headSize() : headSize() + body().size(); }
+
+        // 只序列化状态行与头部，响应体由调用者单独发送，避免大响应体拷贝进输出缓冲区
+        void appendHeadToBuffer(muduo::net::Buffer* outputBuf) const;
+
+        // 先计算序列化后的精确长度，一次预留缓冲区空间，再顺序写入全部字节
         void appendToBuffer(muduo::net::Buffer* outputBuf) const;
     private:
+        void clearFile()
+        {
+            file_.reset();
+            isFile_ = false;
+            fileOffset_ = 0;
+            fileLength_ = 0;
+        }
+
+        // 从p开始写入状态行与头部，返回写入结束的位置，调用者保证空间足够
+        char* writeHead(char* p) const;
+
         // 协议版本
         std::string                        httpVersion_;
         // 状态码
         HttpStatusCode                     statusCode_;
-        // 状态消息
+        // 状态消息，为空表示使用标准原因短语
         std::string                        statusMessage_;
         // 是否关闭连接
         bool                               closeConnection_;
         // 响应头
-        std::map<std::string, std::string> headers_;
+        HttpHeaders                        headers_;
         // 响应体
         std::string                        body_;
+        // 共享的响应体，非空时代替body_
+        std::shared_ptr<const char>        sharedBody_;
+        size_t                             sharedLength_ = 0;
+        // 预先序列化的头部块
+        std::shared_ptr<const std::string> rawHeaders_;
+        // 完整序列化的响应，非空时代替其余全部字段
+        std::shared_ptr<const std::string> serialized_;
+        size_t                             serializedConnection_ = 0;
+        // 是否以文件作为响应体
         bool                               isFile_;
+        std::shared_ptr<const StaticFile>  file_;
+        uint64_t                           fileOffset_;
+        uint64_t                           fileLength_;
     };
 }
\ No newline at end of file
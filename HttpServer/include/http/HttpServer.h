@@ -0,0 +1,115 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include <muduo/net/TcpServer.h>
+#include <muduo/net/EventLoop.h>
+#include <muduo/base/Logging.h>
+#include <muduo/base/noncopyable.h>
+
+#include "HttpContext.h"
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include "StaticFile.h"
+#include "../router/Router.h"
+#include "../middleware/MiddlewareChain.h"
+
+namespace tinyHttp
+{
+    // 基于muduo的HTTP服务器：负责连接管理、请求解析、中间件与路由分派以及响应发送
+    class HttpServer : muduo::noncopyable
+    {
+    public:
+        HttpServer(int port,
+                   const std::string& name,
+                   muduo::net::TcpServer::Option option = muduo::net::TcpServer::kNoReusePort);
+
+        void setThreadNum(int numThreads)
+        { server_.setThreadNum(numThreads); }
+
+        void start();
+
+        muduo::net::EventLoop* getLoop() const
+        { return server_.getLoop(); }
+
+        // 设置请求体最大长度，对之后建立的连接生效
+        void setMaxBodySize(uint64_t maxBodySize)
+        { maxBodySize_ = maxBodySize; }
+
+        // 注册静态路由回调，可调用对象直接内联存放在路由表中
+        template <typename Callback>
+        void Get(const std::string& path, Callback&& callback)
+        { router_.registerCallback(HttpRequest::kGet, path, std::forward<Callback>(callback)); }
+
+        template <typename Callback>
+        void Post(const std::string& path, Callback&& callback)
+        { router_.registerCallback(HttpRequest::kPost, path, std::forward<Callback>(callback)); }
+
+        // 更复杂的路由注册直接通过Router完成
+        Router& router()
+        { return router_; }
+
+        // 中间件需在start()之前注册
+        void addMiddleware(std::shared_ptr<Middleware> middleware)
+        { middlewareChain_.registerMiddleware(std::move(middleware)); }
+
+        // 只对路径前缀匹配的请求生效，如addMiddleware("/api", auth)不影响/static
+        void addMiddleware(const std::string& prefix, std::shared_ptr<Middleware> middleware)
+        { middlewareChain_.registerMiddleware(prefix, std::move(middleware)); }
+
+        // 只对指定的静态路由生效，path含:param或*时返回false
+        bool addRouteMiddleware(HttpRequest::Method method, const std::string& path,
+                                std::shared_ptr<Middleware> middleware)
+        { return middlewareChain_.registerRouteMiddleware(method, path, std::move(middleware)); }
+
+    private:
+        // 正在分片发送的文件响应
+        struct FileTransfer
+        {
+            std::shared_ptr<const StaticFile> file;
+            uint64_t                          offset = 0;
+            uint64_t                          remaining = 0;
+            bool                              close = false; // 发送完成后是否关闭连接
+        };
+
+        // 保存在TcpConnection中的连接状态
+        struct ConnectionState
+        {
+            explicit ConnectionState(uint64_t maxBodySize)
+            : context(maxBodySize)
+            {}
+
+            HttpContext  context;  // 请求解析进度
+            FileTransfer transfer; // 文件发送进度
+        };
+
+        // 不小于该长度的响应体不拷贝进输出缓冲区，与头部分开发送
+        static constexpr size_t kGatherBodySize = 16 * 1024;
+        // 文件响应每次读取并发送的最大字节数，一个连接同时最多只有一个分片在发送缓冲区中
+        static constexpr size_t kFileSliceSize = 64 * 1024;
+
+        void onConnection(const muduo::net::TcpConnectionPtr& conn);
+        void onMessage(const muduo::net::TcpConnectionPtr& conn,
+                       muduo::net::Buffer* buf,
+                       muduo::Timestamp receiveTime);
+        void onWriteComplete(const muduo::net::TcpConnectionPtr& conn);
+        // 处理单个请求并把响应序列化进output，返回处理完后是否需要关闭连接
+        // 大响应体会连同output中已累积的数据一起直接发送到conn，文件响应只写入头部并记录到transfer
+        bool onRequest(const muduo::net::TcpConnectionPtr& conn,
+                       HttpRequest& req,
+                       muduo::net::Buffer* output,
+                       FileTransfer* transfer);
+        // 读取并发送文件的下一个分片
+        void sendFileSlice(const muduo::net::TcpConnectionPtr& conn, FileTransfer* transfer);
+        // 依次执行中间件和路由
+        void handleRequest(HttpRequest& req, HttpResponse* resp);
+
+        muduo::net::InetAddress listenAddr_;  // 监听地址
+        muduo::net::EventLoop   mainLoop_;    // 主事件循环，负责接受连接
+        muduo::net::TcpServer   server_;
+        Router                  router_;
+        MiddlewareChain         middlewareChain_;
+        uint64_t                maxBodySize_;
+    };
+}
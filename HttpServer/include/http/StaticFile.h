@@ -0,0 +1,62 @@
+#pragma once
+
+#include <ctime>
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include <muduo/base/noncopyable.h>
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+
+namespace tinyHttp
+{
+    // 以只读方式打开的静态文件，析构时关闭文件描述符
+    // 响应只持有文件的共享引用，由服务器在连接可写时按固定大小分片读取并发送，文件内容不会整体读入内存
+    class StaticFile : muduo::noncopyable
+    {
+    public:
+        // 打开普通文件，不存在、不可读或不是普通文件时返回nullptr
+        static std::shared_ptr<StaticFile> open(const std::string& path);
+
+        // 根据请求设置文件响应：
+        // If-None-Match/If-Modified-Since命中时返回304，合法的单个Range返回206，无法满足的Range返回416，否则返回200
+        // HEAD请求只设置头部
+        static void respond(const HttpRequest& req, const std::shared_ptr<StaticFile>& file, HttpResponse* resp);
+
+        // 打开path并响应，文件不存在时设置404并返回false
+        // path由调用者负责校验，不能直接使用未经检查的请求路径
+        static bool serve(const HttpRequest& req, const std::string& path, HttpResponse* resp);
+
+        // 根据扩展名推断Content-Type
+        static std::string_view contentType(std::string_view path);
+
+        // 由文件长度与修改时间生成强校验ETag（包括引号）
+        static std::string makeETag(uint64_t size, time_t mtime);
+        // 格式化为HTTP-date，如"Sun, 06 Nov 1994 08:49:37 GMT"
+        static std::string httpDate(time_t t);
+        // If-None-Match/If-Modified-Since是否命中，命中时应返回304
+        static bool notModified(const HttpRequest& req, std::string_view etag, time_t mtime);
+
+        ~StaticFile();
+
+        int fd() const { return fd_; }
+        uint64_t size() const { return size_; }
+        time_t mtime() const { return mtime_; }
+        const std::string& path() const { return path_; }
+        // 由文件长度与修改时间生成的强校验ETag（包括引号）
+        const std::string& etag() const { return etag_; }
+        // HTTP-date格式的修改时间
+        const std::string& lastModified() const { return lastModified_; }
+
+    private:
+        StaticFile(int fd, std::string path, uint64_t size, time_t mtime);
+
+        int         fd_;
+        std::string path_;
+        uint64_t    size_;
+        time_t      mtime_;
+        std::string etag_;
+        std::string lastModified_;
+    };
+}
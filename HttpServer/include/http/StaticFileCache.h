@@ -0,0 +1,111 @@
+#pragma once
+
+#include <ctime>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <muduo/base/noncopyable.h>
+#include <muduo/base/Timestamp.h>
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+
+namespace tinyHttp
+{
+    // 静态资源缓存，按文件路径索引
+    // 缓存项持有读入内存的文件内容、ETag、预先序列化的头部块，以及可压缩类型的gzip/deflate预压缩版本；
+    // 命中时响应体直接引用缓存内容，不产生文件系统调用，也不需要重新格式化头部
+    // 缓存总字节数超过上限时按LRU淘汰，文件的修改时间与长度每隔revalidateInterval秒最多检查一次
+    class StaticFileCache : muduo::noncopyable
+    {
+    public:
+        // 缓存默认占用的最大字节数（包括压缩版本）
+        static constexpr size_t kDefaultMaxBytes = 64 * 1024 * 1024;
+        // 超过该长度的文件不缓存，直接由StaticFile分片发送
+        static constexpr size_t kDefaultMaxEntrySize = 4 * 1024 * 1024;
+
+        explicit StaticFileCache(size_t maxBytes = kDefaultMaxBytes,
+                                 size_t maxEntrySize = kDefaultMaxEntrySize,
+                                 double revalidateInterval = 1.0)
+        : maxBytes_(maxBytes)
+        , maxEntrySize_(maxEntrySize)
+        , revalidateInterval_(revalidateInterval)
+        , bytes_(0)
+        {
+
+        }
+
+        // 以缓存内容响应请求，path由调用者负责校验；带Range的请求与过大的文件交给StaticFile处理
+        // 文件不存在时设置404并返回false
+        bool serve(const HttpRequest& req, const std::string& path, HttpResponse* resp);
+
+        // 使某个文件的缓存失效
+        void invalidate(const std::string& path);
+        void clear();
+
+        size_t size() const;
+        size_t bytes() const;
+
+    private:
+        // 同一文件的一种编码版本
+        struct Variant
+        {
+            std::shared_ptr<const char>        data;    // 响应体，持有者为读入的文件内容或压缩结果
+            size_t                             length = 0;
+            std::string                        etag;    // 各编码版本的ETag互不相同
+            std::shared_ptr<const std::string> headers; // 预先序列化的头部块
+            std::shared_ptr<const std::string> notModifiedHeaders; // 304响应的头部块
+        };
+
+        enum Encoding
+        {
+            kIdentity,
+            kGzip,
+            kDeflate,
+            kNumEncodings
+        };
+
+        struct Entry
+        {
+            std::string      path;
+            uint64_t         size = 0;
+            time_t           mtime = 0;
+            size_t           bytes = 0; // 占用的缓存字节数
+            Variant          variants[kNumEncodings];
+        };
+        using EntryPtr = std::shared_ptr<const Entry>;
+
+        struct Node
+        {
+            EntryPtr         entry;
+            muduo::Timestamp checkedAt; // 上次检查文件是否修改的时间
+        };
+
+        // 从磁盘加载文件并生成缓存项，文件不存在时返回nullptr；
+        // 文件过大或读取时长度发生变化时同样返回nullptr并设置bypass，由StaticFile直接处理
+        std::shared_ptr<Entry> load(const std::string& path, bool* bypass) const;
+        // 查找缓存项，距上次检查超过revalidateInterval_时重新stat文件，需要重新加载时返回nullptr
+        EntryPtr lookup(const std::string& path);
+        void insert(EntryPtr entry);
+        // 调用时已持有mutex_
+        void removeLocked(std::unordered_map<std::string, std::list<Node>::iterator>::iterator it);
+        // 淘汰最久未使用的缓存项直到不超过上限，调用时已持有mutex_
+        void evict();
+
+        // 根据Accept-Encoding选择编码，只在对应压缩版本存在时选择
+        static Encoding chooseEncoding(const HttpRequest& req, const Entry& entry);
+
+        const size_t maxBytes_;
+        const size_t maxEntrySize_;
+        const double revalidateInterval_;
+
+        mutable std::mutex                                          mutex_;
+        // 链表头部为最近使用的缓存项
+        std::list<Node>                                             lru_;
+        std::unordered_map<std::string, std::list<Node>::iterator>  index_;
+        size_t                                                      bytes_;
+    };
+}
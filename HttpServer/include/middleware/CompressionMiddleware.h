@@ -0,0 +1,43 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "Middleware.h"
+
+namespace tinyHttp
+{
+    // 响应压缩中间件
+    // 客户端接受gzip/deflate、响应体不小于minSize且Content-Type在白名单中时压缩响应体
+    // 压缩器状态按线程复用，每个IO线程只初始化一次z_stream，之后每次压缩前只需deflateReset
+    class CompressionMiddleware : public Middleware
+    {
+    public:
+        // 默认的最小压缩长度，更小的响应压缩后节省的字节不足以抵消CPU开销
+        static constexpr size_t kDefaultMinSize = 1024;
+
+        explicit CompressionMiddleware(size_t minSize = kDefaultMinSize, int level = 6);
+
+        // 添加可压缩的Content-Type前缀，默认包括文本、JSON、JavaScript、XML与SVG
+        void addContentType(std::string prefix)
+        { contentTypes_.push_back(std::move(prefix)); }
+
+        bool before(HttpRequest& request, HttpResponse& response) override;
+        void after(const HttpRequest& request, HttpResponse& response) override;
+
+    private:
+        enum Encoding
+        {
+            kNone,
+            kGzip,
+            kDeflate,
+        };
+
+        bool compressible(std::string_view contentType) const;
+
+        const size_t             minSize_;
+        const int                level_;
+        std::vector<std::string> contentTypes_;
+    };
+}
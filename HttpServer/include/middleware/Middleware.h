@@ -4,25 +4,17 @@
 
 namespace tinyHttp
 {
+    // 中间件按注册顺序执行before()，路由处理后按逆序执行after()
     class Middleware
     {
     public:
         virtual ~Middleware() = default;
 
-        virtual void before(HttpRequest& request) = 0;
-        virtual void after(HttpResponse& response) = 0;
+        // 请求到达路由之前调用
+        // 返回false表示中间件已在response中生成了响应（如401、缓存命中），之后的中间件与路由不再执行
+        virtual bool before(HttpRequest& request, HttpResponse& response) = 0;
 
-        void setNext(std::shared_ptr<Middleware> next)
-        {
-            nextMiddleware_ = next;
-        }
-
-        // 可选：提供链式调用的接口（方便组装中间件链）
-        virtual std::shared_ptr<Middleware> getNext() const {
-            return nextMiddleware_;
-        }
-
-    protected:
-        std::shared_ptr<Middleware> nextMiddleware_;
+        // 响应生成之后调用，只对before()返回true的中间件调用
+        virtual void after(const HttpRequest& request, HttpResponse& response) = 0;
     };
-}
\ No newline at end of file
+}
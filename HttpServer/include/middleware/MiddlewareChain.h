@@ -1,52 +1,119 @@
 #pragma once
 
-#include <vector>
-
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
 
-#include <algorithm>
 #include "Middleware.h"
+#include "../router/PerfectHashMap.h"
 
 namespace tinyHttp
 {
+    // 中间件链
+    // 中间件可以全局注册，也可以绑定到路径前缀（如/api，匹配/api与/api/...）或某个具体路由（请求方法 + 精确路径），
+    // 使/static这类路径不必经过鉴权等中间件。compile()为每种绑定组合预先生成一条扁平的中间件数组，
+    // 请求到达时只需选出对应的数组依次调用，热路径上不涉及shared_ptr引用计数与内存分配
     class MiddlewareChain
     {
     public:
-        // 关键修改：参数直接接收 shared_ptr<Middleware>（子类指针可隐式传入）
+        // 扁平的中间件数组，元素由MiddlewareChain持有的shared_ptr保证存活
+        using Pipeline = std::vector<Middleware*>;
+
+        // 全局中间件，对所有请求生效
         void registerMiddleware(std::shared_ptr<Middleware> middleware)
-        {
-            if (!middleware) {
-                return; // 避免传入空指针
-            }
+        { add(kGlobal, HttpRequest::kInvalid, std::string(), std::move(middleware)); }
+
+        // 只对路径前缀匹配的请求生效，前缀按路径段匹配，"/"等价于全局
+        void registerMiddleware(const std::string& prefix, std::shared_ptr<Middleware> middleware)
+        { add(kPrefix, HttpRequest::kInvalid, normalizePrefix(prefix), std::move(middleware)); }
+
+        // 只对指定请求方法与精确路径的路由生效
+        // 绑定按请求路径精确查找，含:param或*的动态路由模式永远不会匹配，这类模式返回false且不注册，
+        // 应改用前缀绑定
+        bool registerRouteMiddleware(HttpRequest::Method method, const std::string& path,
+                                     std::shared_ptr<Middleware> middleware);
 
-            // 直接存储子类的 shared_ptr（指向基类，保持多态）
-            middlewares_.emplace_back(std::move(middleware));
+        // 按当前注册信息生成各条中间件数组，需在开始处理请求之前调用（HttpServer::start()会调用）；
+        // 未调用时第一次选择时加锁生成，多个线程同时到达也只生成一次
+        void compile();
 
-            // 可选：自动串联下一个中间件（如果需要链式调用）
-            if (middlewares_.size() >= 2) {
-                auto& prev = middlewares_[middlewares_.size() - 2];
-                auto& curr = middlewares_[middlewares_.size() - 1];
-                prev->setNext(curr);
+        // 选出请求对应的中间件数组，优先精确路由，其次最长的匹配前缀，最后是全局
+        const Pipeline& select(const HttpRequest& request);
+
+        // 按顺序执行before()，passed返回before()返回true的中间件数量
+        // 返回false表示被某个中间件短路，response已由该中间件生成
+        static bool handleRequest(const Pipeline& pipeline, HttpRequest& request,
+                                  HttpResponse& response, size_t* passed)
+        {
+            for (size_t i = 0; i < pipeline.size(); ++i)
+            {
+                if (!pipeline[i]->before(request, response))
+                {
+                    *passed = i;
+                    return false;
+                }
             }
+            *passed = pipeline.size();
+            return true;
         }
 
-        // 示例：执行所有中间件的 before 方法（按注册顺序）
-        void handleRequest(HttpRequest& request) const
+        // 按注册逆序对前passed个中间件执行after()
+        static void handleResponse(const Pipeline& pipeline, size_t passed,
+                                   const HttpRequest& request, HttpResponse& response)
         {
-            for (auto& mid : middlewares_) {
-                mid->before(request);
+            for (size_t i = passed; i > 0; --i)
+            {
+                pipeline[i - 1]->after(request, response);
             }
         }
 
-        // 示例：执行所有中间件的 after 方法（按注册逆序，符合中间件逻辑）
-        void handleResponse(HttpResponse& response) {
-            for (auto it = middlewares_.rbegin(); it != middlewares_.rend(); ++it) {
-                (*it)->after(response);
+        bool empty() const { return bindings_.empty(); }
+
+    private:
+        enum Scope
+        {
+            kGlobal,
+            kPrefix,
+            kRoute,
+        };
+
+        struct Binding
+        {
+            Scope                       scope;
+            HttpRequest::Method         method;
+            std::string                 path;
+            std::shared_ptr<Middleware> middleware;
+        };
+
+        void add(Scope scope, HttpRequest::Method method, std::string path, std::shared_ptr<Middleware> middleware)
+        {
+            if (!middleware)
+            {
+                return; // 避免传入空指针
             }
+            bindings_.push_back(Binding{scope, method, std::move(path), std::move(middleware)});
+            compiled_.store(false, std::memory_order_relaxed);
         }
 
-    private:
-        // 存储基类的 shared_ptr（实际指向子类实例）
-        std::vector<std::shared_ptr<Middleware>> middlewares_;
+        static std::string normalizePrefix(const std::string& prefix);
+        static bool prefixMatches(std::string_view prefix, std::string_view path)
+        {
+            return path.substr(0, prefix.size()) == prefix &&
+                   (path.size() == prefix.size() || path[prefix.size()] == '/');
+        }
+
+        // 生成路径path在方法method下应执行的中间件数组，exact为true时包含精确路由绑定
+        Pipeline collect(HttpRequest::Method method, std::string_view path, bool exact) const;
+
+        std::vector<Binding>                          bindings_;  // 按注册顺序存放
+        std::mutex                                    mutex_;     // 保护首次选择时的自动生成
+        std::atomic<bool>                             compiled_{false};
+        Pipeline                                      global_;
+        std::vector<std::pair<std::string, Pipeline>> prefixes_;  // 按前缀长度降序排列
+        std::vector<Pipeline>                         routePipelines_;
+        PerfectHashMap<int>                           routes_;    // (方法, 路径) -> routePipelines_下标
     };
 }
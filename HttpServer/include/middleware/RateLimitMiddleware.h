@@ -0,0 +1,94 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <muduo/net/EventLoop.h>
+#include "Middleware.h"
+
+namespace tinyHttp
+{
+    // 令牌桶限流中间件
+    // 按客户端IP（或指定请求头的值，如X-Api-Key）区分客户端，每个客户端每秒补充rate个令牌，最多积累burst个；
+    // 令牌不足的请求直接返回429并带上Retry-After，不再进入后续中间件与路由
+    //
+    // 每个令牌桶以GCRA形式保存为一个原子的"理论到达时间"，取令牌与补充都是一次CAS，不需要加锁；
+    // 桶按客户端键的哈希分布在多个分段中，查找已有的桶只持有所在分段的读锁，只有新客户端首次出现时才加写锁。
+    // 每个分段最多保存maxBuckets / kShards个桶：分段满时先就地清理令牌已补满的桶，仍然满则按请求头区分的
+    // 请求退回按IP限流，按IP的请求直接返回429，因此不调用startEviction()内存也有上限；
+    // startEviction()只用于及早释放长时间不活跃的桶，需在服务器启动后手动调用
+    class RateLimitMiddleware : public Middleware,
+                                public std::enable_shared_from_this<RateLimitMiddleware>
+    {
+    public:
+        static constexpr size_t kShards = 64;
+        static constexpr size_t kDefaultMaxBuckets = 64 * 1024;
+
+        // keyHeader为空时按客户端IP限流，否则按该请求头的值限流，请求不带该头部时退回按IP
+        RateLimitMiddleware(double ratePerSecond, double burst, std::string keyHeader = std::string(),
+                            size_t maxBuckets = kDefaultMaxBuckets);
+
+        bool before(HttpRequest& request, HttpResponse& response) override;
+        void after(const HttpRequest&, HttpResponse&) override {}
+
+        // 尝试为客户端取一个令牌，被拒绝时retryAfter返回需要等待的秒数；桶数量已达上限的新客户端也被拒绝
+        bool tryAcquire(std::string_view key, double* retryAfter = nullptr)
+        { return acquire(key, retryAfter) == kAcquired; }
+
+        // 清理空闲超过idleSeconds（且令牌已补满）的桶，返回清理的数量
+        size_t evictIdle(double idleSeconds);
+
+        // 在loop上每隔interval秒清理一次空闲桶，中间件需由shared_ptr持有，销毁后定时任务自动失效
+        void startEviction(muduo::net::EventLoop* loop, double interval = 30.0, double idleSeconds = 60.0);
+
+        size_t size() const;
+
+    private:
+        enum AcquireResult
+        {
+            kAcquired,
+            kLimited,   // 令牌不足
+            kFull,      // 新客户端且所在分段的桶已满
+        };
+
+        struct Bucket
+        {
+            explicit Bucket(std::string_view k)
+            : key(k)
+            {}
+
+            const std::string    key;
+            // 下一个令牌可用的理论时间（纳秒），令牌桶满时不晚于当前时间
+            std::atomic<int64_t> tat{0};
+        };
+
+        // 表的键引用桶自身保存的字符串，查找时不需要构造std::string
+        struct Shard
+        {
+            mutable std::shared_mutex                                      mutex;
+            std::unordered_map<std::string_view, std::unique_ptr<Bucket>> buckets;
+            // 上次就地清理后剩余桶中最早补满的时间，此前再次清理不会有收获，受写锁保护
+            int64_t                                                        nextIdle = 0;
+        };
+
+        static int64_t nowNanos();
+
+        AcquireResult acquire(std::string_view key, double* retryAfter);
+        // 分段已满时清理其中令牌已补满的桶，返回是否有空位，调用方持有写锁
+        bool makeRoom(Shard& shard, int64_t now);
+
+        Shard& shardOf(std::string_view key)
+        { return shards_[std::hash<std::string_view>{}(key) % kShards]; }
+
+        const int64_t     interval_;    // 每个令牌的补充间隔（纳秒）
+        const int64_t     burstWindow_; // burst个令牌对应的时间窗口（纳秒）
+        const std::string keyHeader_;
+        const size_t      maxShardBuckets_;
+        Shard             shards_[kShards];
+    };
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include <muduo/base/Timestamp.h>
+#include "Middleware.h"
+
+namespace tinyHttp
+{
+    // GET/HEAD响应缓存中间件
+    // 缓存键由请求方法、协议版本、路径、按参数名排序的查询参数以及选定的Vary请求头组成；
+    // 缓存项保存完整序列化的响应字节，命中时before()直接以这块字节作为响应并短路后续中间件与路由，
+    // 发送时只需一次追加到输出缓冲区
+    // 有效期取响应Cache-Control的s-maxage/max-age，未声明时使用默认TTL；no-store、no-cache、private、
+    // 带Set-Cookie的响应以及带Authorization的请求不缓存
+    // 带Cookie的请求默认也不缓存：会话复用时响应不带Set-Cookie，个性化内容会被其他用户命中
+    // 响应的Vary为*或列出了不参与缓存键的请求头时不缓存
+    // 缓存按键的哈希分为多个分段，每段各自加锁并维护LRU，总字节数超过上限时淘汰最久未使用的项
+    //
+    // 与CompressionMiddleware同时使用时应先注册本中间件，使缓存保存的是压缩后的响应
+    class ResponseCacheMiddleware : public Middleware
+    {
+    public:
+        static constexpr size_t kDefaultMaxBytes = 32 * 1024 * 1024;
+        static constexpr size_t kDefaultMaxEntrySize = 1024 * 1024;
+        static constexpr size_t kStripes = 16;
+
+        explicit ResponseCacheMiddleware(double defaultTtl = 5.0,
+                                         size_t maxBytes = kDefaultMaxBytes,
+                                         size_t maxEntrySize = kDefaultMaxEntrySize);
+
+        // 添加参与缓存键的请求头，默认只有Accept-Encoding（按接受的压缩编码归一化）
+        void addVaryHeader(std::string name)
+        { varyHeaders_.push_back(std::move(name)); }
+
+        // 允许缓存带Cookie的请求，仅在响应不依赖Cookie时开启；
+        // 若响应按Cookie区分，应改为addVaryHeader("Cookie")
+        void setCacheCookieRequests(bool on)
+        { cacheCookieRequests_ = on; }
+
+        bool before(HttpRequest& request, HttpResponse& response) override;
+        void after(const HttpRequest& request, HttpResponse& response) override;
+
+        // 使某个路径的所有缓存项失效，数据更新后调用
+        void invalidate(std::string_view path);
+        void clear();
+
+        size_t size() const;
+        size_t bytes() const;
+
+    private:
+        struct Entry
+        {
+            std::string                        key;
+            std::shared_ptr<const std::string> bytes; // 完整序列化的响应
+            size_t                             connectionOffset = 0;
+            HttpResponse::HttpStatusCode       status = HttpResponse::k200Ok;
+            muduo::Timestamp                   expires;
+        };
+
+        // 一个加锁分段
+        struct Stripe
+        {
+            mutable std::mutex                                         mutex;
+            std::list<Entry>                                           lru;   // 表头为最近使用
+            std::unordered_map<std::string_view, std::list<Entry>::iterator> index; // 键指向lru中的字符串
+            size_t                                                     bytes = 0;
+        };
+
+        // 构造缓存键，请求不可缓存时返回false
+        bool makeKey(const HttpRequest& request, std::string* key) const;
+        // 请求头是否参与缓存键
+        bool isVaryHeader(std::string_view name) const;
+        Stripe& stripeOf(std::string_view key);
+        void evict(Stripe& stripe, std::list<Entry>::iterator it);
+
+        const double             defaultTtl_;
+        const size_t             maxStripeBytes_;
+        const size_t             maxEntrySize_;
+        std::vector<std::string> varyHeaders_;
+        bool                     cacheCookieRequests_ = false;
+        Stripe                   stripes_[kStripes];
+    };
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <cstddef>
+#include <tuple>
+#include <utility>
+
+#include "Middleware.h"
+
+namespace tinyHttp
+{
+    // 编译期组合的中间件链
+    // 中间件类型作为模板参数直接保存在tuple中，before()/after()以限定名调用，不经过虚函数与shared_ptr，
+    // 整条链可以内联展开为一个函数。各中间件只需提供与Middleware相同签名的before与after，不要求继承Middleware
+    // 链本身实现了Middleware接口，可以作为一个整体注册进动态的MiddlewareChain，与插件式中间件混合使用
+    //
+    // 语义与MiddlewareChain一致：按顺序执行before()，某个中间件返回false时短路，
+    // 已放行请求的中间件按逆序执行after()
+    template <typename... Ms>
+    class StaticMiddlewareChain final : public Middleware
+    {
+    public:
+        StaticMiddlewareChain() = default;
+
+        explicit StaticMiddlewareChain(Ms... middlewares)
+        : middlewares_(std::move(middlewares)...)
+        {}
+
+        template <size_t I>
+        auto& get() { return std::get<I>(middlewares_); }
+
+        template <typename M>
+        M& get() { return std::get<M>(middlewares_); }
+
+        // 短路时链内已放行的中间件立即执行after()，此时链整体返回false，外层不会再调用after()
+        bool before(HttpRequest& request, HttpResponse& response) override
+        {
+            return beforeFrom<0>(request, response);
+        }
+
+        void after(const HttpRequest& request, HttpResponse& response) override
+        {
+            afterUntil<sizeof...(Ms)>(request, response);
+        }
+
+        // 执行完整的before -> handler -> after流程，handler可以是Router::route的包装
+        template <typename Handler>
+        void handle(HttpRequest& request, HttpResponse& response, Handler&& handler)
+        {
+            if (beforeFrom<0>(request, response))
+            {
+                handler(request, response);
+                afterUntil<sizeof...(Ms)>(request, response);
+            }
+        }
+
+    private:
+        template <size_t I>
+        using Type = std::tuple_element_t<I, std::tuple<Ms...>>;
+
+        template <size_t I>
+        bool beforeFrom(HttpRequest& request, HttpResponse& response)
+        {
+            if constexpr (I == sizeof...(Ms))
+            {
+                return true;
+            }
+            else
+            {
+                using M = Type<I>;
+                if (!std::get<I>(middlewares_).M::before(request, response))
+                {
+                    afterUntil<I>(request, response);
+                    return false;
+                }
+                return beforeFrom<I + 1>(request, response);
+            }
+        }
+
+        // 按逆序对前N个中间件执行after()
+        template <size_t N>
+        void afterUntil(const HttpRequest& request, HttpResponse& response)
+        {
+            if constexpr (N > 0)
+            {
+                using M = Type<N - 1>;
+                std::get<N - 1>(middlewares_).M::after(request, response);
+                afterUntil<N - 1>(request, response);
+            }
+        }
+
+        std::tuple<Ms...> middlewares_;
+    };
+}
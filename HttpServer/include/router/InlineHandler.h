@@ -0,0 +1,160 @@
+#pragma once
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "../http/HttpRequest.h"
+#include "../http/HttpResponse.h"
+
+namespace tinyHttp
+{
+    // 类型擦除的路由处理函数，签名为void(const HttpRequest&, HttpResponse*)
+    // 不超过kInlineSize字节且可无异常移动的可调用对象直接存放在对象内部，构造与调用都不分配内存；
+    // 更大的对象退化为堆上存放。与std::function相比少一次间接跳转，也不需要处理器对象的shared_ptr与虚函数
+    class InlineHandler
+    {
+    public:
+        static constexpr size_t kInlineSize = 48;
+
+        InlineHandler() noexcept
+        : ops_(nullptr)
+        {}
+
+        template <typename F,
+                  typename = std::enable_if_t<!std::is_same<std::decay_t<F>, InlineHandler>::value>>
+        InlineHandler(F &&f)
+        : ops_(nullptr)
+        {
+            using Fn = std::decay_t<F>;
+            if constexpr (kStoredInline<Fn>)
+            {
+                new (storage_) Fn(std::forward<F>(f));
+                ops_ = &InlineOps<Fn>::kOps;
+            }
+            else
+            {
+                new (storage_) Fn *(new Fn(std::forward<F>(f)));
+                ops_ = &HeapOps<Fn>::kOps;
+            }
+        }
+
+        InlineHandler(const InlineHandler &other)
+        : ops_(nullptr)
+        {
+            if (other.ops_)
+            {
+                other.ops_->copy(storage_, other.storage_);
+                ops_ = other.ops_;
+            }
+        }
+
+        InlineHandler(InlineHandler &&other) noexcept
+        : ops_(nullptr)
+        {
+            moveFrom(other);
+        }
+
+        InlineHandler &operator=(const InlineHandler &other)
+        {
+            if (this != &other)
+            {
+                InlineHandler copy(other);
+                reset();
+                moveFrom(copy);
+            }
+            return *this;
+        }
+
+        InlineHandler &operator=(InlineHandler &&other) noexcept
+        {
+            if (this != &other)
+            {
+                reset();
+                moveFrom(other);
+            }
+            return *this;
+        }
+
+        ~InlineHandler()
+        {
+            reset();
+        }
+
+        // 与std::function一致，const对象也可以调用可变的可调用对象
+        void operator()(const HttpRequest &req, HttpResponse *resp) const
+        {
+            ops_->invoke(const_cast<unsigned char *>(storage_), req, resp);
+        }
+
+        explicit operator bool() const noexcept
+        { return ops_ != nullptr; }
+
+    private:
+        struct Ops
+        {
+            void (*invoke)(void *self, const HttpRequest &req, HttpResponse *resp);
+            void (*copy)(void *dst, const void *src);
+            void (*move)(void *dst, void *src) noexcept; // 移动后销毁源对象
+            void (*destroy)(void *self) noexcept;
+        };
+
+        template <typename Fn>
+        static constexpr bool kStoredInline = sizeof(Fn) <= kInlineSize &&
+                                              alignof(Fn) <= alignof(std::max_align_t) &&
+                                              std::is_nothrow_move_constructible<Fn>::value;
+
+        template <typename Fn>
+        struct InlineOps
+        {
+            static Fn *get(void *p) { return std::launder(reinterpret_cast<Fn *>(p)); }
+
+            static void invoke(void *self, const HttpRequest &req, HttpResponse *resp) { (*get(self))(req, resp); }
+            static void copy(void *dst, const void *src) { new (dst) Fn(*get(const_cast<void *>(src))); }
+            static void move(void *dst, void *src) noexcept
+            {
+                new (dst) Fn(std::move(*get(src)));
+                get(src)->~Fn();
+            }
+            static void destroy(void *self) noexcept { get(self)->~Fn(); }
+
+            static constexpr Ops kOps{invoke, copy, move, destroy};
+        };
+
+        template <typename Fn>
+        struct HeapOps
+        {
+            static Fn *&get(void *p) { return *std::launder(reinterpret_cast<Fn **>(p)); }
+
+            static void invoke(void *self, const HttpRequest &req, HttpResponse *resp) { (*get(self))(req, resp); }
+            static void copy(void *dst, const void *src) { new (dst) Fn *(new Fn(*get(const_cast<void *>(src)))); }
+            static void move(void *dst, void *src) noexcept { new (dst) Fn *(get(src)); }
+            static void destroy(void *self) noexcept { delete get(self); }
+
+            static constexpr Ops kOps{invoke, copy, move, destroy};
+        };
+
+        void moveFrom(InlineHandler &other) noexcept
+        {
+            if (other.ops_)
+            {
+                other.ops_->move(storage_, other.storage_);
+                ops_ = other.ops_;
+                other.ops_ = nullptr;
+            }
+        }
+
+        void reset() noexcept
+        {
+            if (ops_)
+            {
+                ops_->destroy(storage_);
+                ops_ = nullptr;
+            }
+        }
+
+        alignas(std::max_align_t) unsigned char storage_[kInlineSize];
+        const Ops                               *ops_;
+    };
+}
@@ -0,0 +1,160 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+namespace tinyHttp
+{
+    // 构建后只读的完美哈希表，键为(请求方法, 路径)
+    // 采用两级"哈希-位移"方案：第一级把键分到若干桶，构建时为每个桶寻找一个位移种子，
+    // 使所有键在第二级槽位中互不冲突；查找固定计算两次哈希、比较一次键，不需要探测，也不需要构造std::string
+    template <typename T>
+    class PerfectHashMap
+    {
+    public:
+        struct Entry
+        {
+            int         method;
+            std::string path;
+            T           value;
+        };
+
+        PerfectHashMap() = default;
+
+        // 由互不重复的键构建，构建完成后不再修改
+        explicit PerfectHashMap(std::vector<Entry> entries)
+        : entries_(std::move(entries))
+        {
+            build();
+        }
+
+        const T* find(int method, std::string_view path) const
+        {
+            if (entries_.empty())
+            {
+                return nullptr;
+            }
+            const uint32_t bucket = static_cast<uint32_t>(hash(method, path, 0) % seeds_.size());
+            const int32_t index = slots_[hash(method, path, seeds_[bucket]) & (slots_.size() - 1)];
+            if (index < 0)
+            {
+                return nullptr;
+            }
+            const Entry& entry = entries_[index];
+            return entry.method == method && entry.path == path ? &entry.value : nullptr;
+        }
+
+        size_t size() const { return entries_.size(); }
+        bool empty() const { return entries_.empty(); }
+        const std::vector<Entry>& entries() const { return entries_; }
+
+    private:
+        static uint64_t hash(int method, std::string_view path, uint32_t seed)
+        {
+            // 带种子的FNV-1a，最后做一次混合使低位分布均匀
+            uint64_t h = 14695981039346656037ull ^ (static_cast<uint64_t>(seed) * 0x9e3779b97f4a7c15ull);
+            h = (h ^ static_cast<uint64_t>(method)) * 1099511628211ull;
+            for (char c : path)
+            {
+                h = (h ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+            }
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdull;
+            h ^= h >> 33;
+            return h;
+        }
+
+        void build()
+        {
+            if (entries_.empty())
+            {
+                return;
+            }
+            // 槽位数取不小于键数量2倍的2的幂，每个桶平均约1个键，构建很快即可找到位移
+            size_t slotCount = 1;
+            while (slotCount < entries_.size() * 2)
+            {
+                slotCount <<= 1;
+            }
+            while (!tryBuild(slotCount))
+            {
+                slotCount <<= 1;
+            }
+        }
+
+        bool tryBuild(size_t slotCount)
+        {
+            const size_t bucketCount = entries_.size();
+            std::vector<std::vector<int32_t>> buckets(bucketCount);
+            for (size_t i = 0; i < entries_.size(); ++i)
+            {
+                const Entry& e = entries_[i];
+                buckets[hash(e.method, e.path, 0) % bucketCount].push_back(static_cast<int32_t>(i));
+            }
+            // 先处理键最多的桶，越往后空槽越少，小桶更容易放下
+            std::vector<size_t> order(bucketCount);
+            for (size_t i = 0; i < bucketCount; ++i)
+            {
+                order[i] = i;
+            }
+            std::sort(order.begin(), order.end(),
+                      [&](size_t a, size_t b) { return buckets[a].size() > buckets[b].size(); });
+
+            slots_.assign(slotCount, -1);
+            seeds_.assign(bucketCount, 0);
+            std::vector<size_t> placed;
+            for (size_t b : order)
+            {
+                const std::vector<int32_t>& keys = buckets[b];
+                if (keys.empty())
+                {
+                    break;
+                }
+                bool found = false;
+                for (uint32_t seed = 1; seed < kMaxSeed && !found; ++seed)
+                {
+                    placed.clear();
+                    found = true;
+                    for (int32_t index : keys)
+                    {
+                        const Entry& e = entries_[index];
+                        const size_t slot = hash(e.method, e.path, seed) & (slotCount - 1);
+                        if (slots_[slot] != -1)
+                        {
+                            found = false;
+                            break;
+                        }
+                        slots_[slot] = index;
+                        placed.push_back(slot);
+                    }
+                    if (!found)
+                    {
+                        for (size_t slot : placed)
+                        {
+                            slots_[slot] = -1;
+                        }
+                    }
+                    else
+                    {
+                        seeds_[b] = seed;
+                    }
+                }
+                if (!found)
+                {
+                    return false; // 加大槽位后重试
+                }
+            }
+            return true;
+        }
+
+        static constexpr uint32_t kMaxSeed = 1u << 16;
+
+        std::vector<Entry>    entries_;
+        std::vector<uint32_t> seeds_;  // 每个桶的位移种子
+        std::vector<int32_t>  slots_;  // 槽位中存放的键下标，-1表示空
+    };
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "../http/HttpRequest.h"
+
+namespace tinyHttp
+{
+    // 按路由统计的请求计数与处理耗时
+    // 每个线程写入自己的分片，热路径上只有本线程读写的普通原子变量，不与其他线程竞争；读取时合并全部分片
+    // 耗时用HDR风格的对数-线性直方图记录（微秒）：每个2的幂区间再等分为8个子桶，相对误差不超过12.5%
+    class RouteMetrics
+    {
+    public:
+        // 直方图桶：0~15微秒各占一个桶，之后每个2的幂区间8个桶，上限约19小时
+        static constexpr size_t kExactBuckets = 16;
+        static constexpr size_t kSubBucketBits = 3;
+        static constexpr size_t kMaxExponent = 36;
+        static constexpr size_t kBucketCount =
+            kExactBuckets + (kMaxExponent - 4) * (size_t(1) << kSubBucketBits);
+
+        // 单个分片中路由统计的分块大小与块数，可统计的路由数量上限为二者之积
+        static constexpr size_t kChunkRoutes = 16;
+        static constexpr size_t kMaxChunks = 1024;
+
+        static constexpr int kNoMetric = -1;
+
+        // 合并后的单个路由统计
+        struct RouteStats
+        {
+            HttpRequest::Method                method;
+            std::string                        route;      // 注册时的路径或模式，未命中的请求为空
+            uint64_t                           count = 0;
+            uint64_t                           sumMicros = 0;
+            std::array<uint64_t, kBucketCount> buckets{};
+
+            // 返回不小于q（0~1）比例请求的耗时上界（微秒）
+            uint64_t percentile(double q) const;
+        };
+
+        RouteMetrics();
+        ~RouteMetrics();
+
+        RouteMetrics(const RouteMetrics&) = delete;
+        RouteMetrics& operator=(const RouteMetrics&) = delete;
+
+        // 返回路由的统计编号，同一方法与路由重复注册时返回同一编号，路由表重新编译后统计不会清零
+        int metricId(HttpRequest::Method method, const std::string& route);
+
+        // 未命中任何路由的请求使用的统计编号
+        int unmatchedId(HttpRequest::Method method) const
+        { return static_cast<int>(method); }
+
+        // 记录一次请求，只在调用线程的分片中写入
+        void record(int id, uint64_t micros);
+
+        // 合并所有分片，只返回有请求的路由
+        std::vector<RouteStats> snapshot() const;
+
+        // 以Prometheus文本格式输出计数器与耗时直方图
+        std::string renderPrometheus() const;
+
+        static size_t bucketIndex(uint64_t micros);
+        // 桶内的最大值（微秒）
+        static uint64_t bucketUpperBound(size_t index);
+
+    private:
+        struct Counters
+        {
+            std::atomic<uint64_t>                            count{0};
+            std::atomic<uint64_t>                            sumMicros{0};
+            std::array<std::atomic<uint64_t>, kBucketCount>  buckets{};
+        };
+
+        struct Chunk
+        {
+            std::array<Counters, kChunkRoutes> routes;
+        };
+
+        // 单个线程的统计分片，只由所属线程写入，块在第一次用到时分配
+        struct Shard
+        {
+            Shard();
+            ~Shard();
+
+            std::array<std::atomic<Chunk*>, kMaxChunks> chunks;
+        };
+
+        struct RouteName
+        {
+            HttpRequest::Method method;
+            std::string         route;
+        };
+
+        Shard* localShard();
+
+        const uint64_t                                              id_;     // 全局唯一，用于线程缓存识别所属的RouteMetrics
+        mutable std::mutex                                          mutex_;  // 保护以下成员，只在注册、读取与线程首次记录时加锁
+        std::unordered_map<std::thread::id, std::unique_ptr<Shard>> threadShards_; // 每个线程一个分片
+        std::vector<RouteName>                                      names_;  // 按统计编号存放
+        std::unordered_map<std::string, int>                        ids_;    // "方法 路由" -> 统计编号
+    };
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "../http/HttpRequest.h"
+
+namespace tinyHttp
+{
+    // 按路径段组织的路由前缀树
+    // 路由模式由'/'分隔的段组成：普通段精确匹配，":name"段匹配任意非空的单个段，"*name"段（只能位于末尾）匹配剩余的全部路径
+    // 匹配时逐段向下查找，优先级为普通段 > 参数段 > 通配段，失败时回溯；参数只记录在路径中的偏移，不产生拷贝
+    class RouteTrie
+    {
+    public:
+        // 单个路由最多包含的参数段（包括通配段）数量
+        static constexpr size_t kMaxParams = 8;
+        static constexpr int kNoRoute = -1;
+
+        // 路径参数在请求路径中的位置
+        struct Capture
+        {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        struct Match
+        {
+            int                              route = kNoRoute; // 命中的路由编号
+            std::array<Capture, kMaxParams>  captures;         // 按参数在模式中出现的顺序排列
+            size_t                           count = 0;
+        };
+
+        RouteTrie();
+        ~RouteTrie();
+        RouteTrie(RouteTrie&&) noexcept;
+        RouteTrie& operator=(RouteTrie&&) noexcept;
+
+        // 插入路由模式，route为调用者分配的路由编号，同一方法与模式重复插入时覆盖
+        // 模式格式错误时返回false，paramNames按顺序返回参数名（不含':'与'*'，未命名的通配段为"*"）
+        bool insert(HttpRequest::Method method, std::string_view pattern, int route,
+                    std::vector<std::string>* paramNames);
+
+        // 匹配请求路径，未命中时match->route为kNoRoute
+        bool match(HttpRequest::Method method, std::string_view path, Match* match) const;
+
+        bool empty() const;
+
+    private:
+        static constexpr size_t kMethodCount = static_cast<size_t>(HttpRequest::kOptions) + 1;
+
+        struct Node;
+        using NodePtr = std::unique_ptr<Node>;
+
+        // 从pos开始匹配剩余路径，pos为npos表示路径已全部匹配
+        static int matchNode(const Node* node, HttpRequest::Method method,
+                             std::string_view path, size_t pos, Match* match);
+
+        NodePtr root_;
+    };
+}
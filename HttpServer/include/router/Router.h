@@ -1,15 +1,18 @@
 #pragma once
 
-#pragma once
+#include <atomic>
 #include <iostream>
+#include <mutex>
 #include <unordered_map>
 #include <string>
 #include <memory>
 #include <functional>
-#include <regex>
 #include <vector>
 
+#include "InlineHandler.h"
 #include "RouterHandler.h"
+#include "RouteMetrics.h"
+#include "RouteTrie.h"
 #include "../http/HttpRequest.h"
 #include "../http/HttpResponse.h"
 
@@ -17,7 +20,13 @@ namespace tinyHttp
 {
     // 选择注册对象式的路由处理器还是注册回调函数式的处理器取决于处理器执行的复杂程度
     // 如果是简单的处理可以注册回调函数，否则注册对象式路由处理器(对象中可封装多个相关函数)
-    // 二者注册其一即可
+    // 二者注册其一即可，同一方法与路径重复注册时后者覆盖前者
+    // 两种形式注册后统一保存为InlineHandler，回调函数直接内联存放在路由表中，分派时不经过std::function与虚函数
+    //
+    // 注册的路由经compile()编译为不可变的路由表后才对请求生效，IO线程查找路由时不加锁：
+    // 路由表通过原子指针发布，每个线程缓存当前路由表的引用，只在版本号变化时重新加载。
+    // 运行中可以修改注册信息后再次compile()热替换路由表，旧路由表在各线程处理完手头的请求后释放。
+    // 首次路由前未调用compile()时自动编译一次
     class Router
     {
     public:
@@ -25,6 +34,19 @@ namespace tinyHttp
 
         using HandlerCallback = std::function<void(const HttpRequest &, HttpResponse *)>;
 
+        // 流式请求体处理器，适用于大文件上传等不希望把整个请求体缓存在内存中的场景
+        // 请求体每到达一段就调用一次onData，返回实际消费的字节数；返回值小于len时连接暂停读取（背压），
+        // 随后调用onPause交给处理器一个resume回调，处理器能够继续接收时调用它，未消费的数据再重新交给onData；
+        // 请求体接收完毕后调用onComplete生成响应
+        struct StreamingHandler
+        {
+            std::function<size_t(const HttpRequest &, const char *data, size_t len)> onData;
+            // onData会返回小于len的值时必须提供，resume可在任意线程调用
+            std::function<void(const HttpRequest &, std::function<void()> resume)> onPause;
+            HandlerCallback onComplete;
+            uint64_t maxBodySize = UINT64_MAX; // 流式请求体的长度上限，替代服务器的请求体上限
+        };
+
         // 路由键（请求方法 + URI）
         struct RouteKey
         {
@@ -51,74 +73,120 @@ namespace tinyHttp
         };
 
         // 注册路由处理器
-        void registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler);
+        void registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler)
+        {
+            registerRoute(method, path, wrapHandler(std::move(handler)));
+        }
 
-        // 注册回调函数形式的处理器
-        void registerCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback);
+        // 注册回调函数形式的处理器，接受任意签名兼容的可调用对象（lambda、函数指针、HandlerCallback等）
+        template <typename Callback>
+        void registerCallback(HttpRequest::Method method, const std::string &path, Callback &&callback)
+        {
+            registerRoute(method, path, InlineHandler(std::forward<Callback>(callback)));
+        }
+
+        // 注册流式请求体处理器，仅支持精准匹配的路径
+        void registerStreamingHandler(HttpRequest::Method method, const std::string &path, StreamingHandler handler);
+
+        // 查找请求对应的流式处理器，请求头解析完成后调用，未注册时返回nullptr
+        const StreamingHandler *findStreamingHandler(const HttpRequest &req) const;
 
         // 注册动态路由处理器
+        // 路由模式支持":name"参数段与末尾的"*name"通配段，如/user/:id/profile/:section、/static/*filepath
         void addRegexHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler)
         {
-            std::regex pathRegex = convertToRegex(path);
-            regexHandlers_.emplace_back(method, pathRegex, handler);
+            addDynamicRoute(method, path, wrapHandler(std::move(handler)));
         }
 
         // 注册动态路由处理函数
-        void addRegexCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback)
+        template <typename Callback>
+        void addRegexCallback(HttpRequest::Method method, const std::string &path, Callback &&callback)
+        {
+            addDynamicRoute(method, path, InlineHandler(std::forward<Callback>(callback)));
+        }
+
+        // 清空注册信息，正在使用的路由表不受影响，直到下一次compile()
+        void clear();
+
+        // 把当前注册的路由编译为新的路由表并原子地替换正在使用的路由表
+        void compile();
+
+        // 当前路由表的版本号，每次compile()后变化，尚未编译时为0
+        uint64_t version() const
+        { return version_.load(std::memory_order_acquire); }
+
+        // 处理请求，动态路由命中时把路径参数按声明的名字写入请求
+        bool route(HttpRequest &req, HttpResponse *resp);
+
+        // 是否统计各路由的请求数与处理耗时，默认开启，下一次compile()后生效
+        void setMetricsEnabled(bool on)
         {
-            std::regex pathRegex = convertToRegex(path);
-            regexCallbacks_.emplace_back(method, pathRegex, callback);
+            std::lock_guard<std::mutex> lock(mutex_);
+            metricsEnabled_ = on;
         }
 
-        // 处理请求
-        bool route(const HttpRequest &req, HttpResponse *resp);
+        // 路由统计，按注册的路径或模式区分，未命中的请求按请求方法归入路由为空的一项
+        const RouteMetrics &metrics() const
+        { return metrics_; }
+
+        // 注册以Prometheus文本格式输出路由统计的GET接口
+        void registerMetricsEndpoint(const std::string &path = "/metrics");
 
     private:
-        // 根据传入路径来生成正则表达式，该正则表达式会在路由匹配时使用
-        // 输入路由模式：/user/:id/profile/:section （路由模式由用户定义）
-        // 生成正则：^/user/([^/]+)/profile/([^/]+)$（该正则表达式用于在函数extractPathParameters中提取路径参数）
-        std::regex convertToRegex(const std::string &pathPattern)
+        struct RouteTable;
+
+        static InlineHandler wrapHandler(HandlerPtr handler)
         {
-            // 将路径模式转换为正则表达式，支持匹配任意路径参数
-            std::string regexPattern = "^" + std::regex_replace(pathPattern, std::regex(R"(/:([^/]+))"), R"(/([^/]+))") + "$";
-            return std::regex(regexPattern);
+            return InlineHandler([handler = std::move(handler)](const HttpRequest &req, HttpResponse *resp) {
+                handler->handle(req, resp);
+            });
         }
 
-        // 提取路径参数
-        void extractPathParameters(const std::smatch &match, HttpRequest &request)
+        void registerRoute(HttpRequest::Method method, const std::string &path, InlineHandler handler);
+        void addDynamicRoute(HttpRequest::Method method, const std::string &path, InlineHandler handler);
+
+        // 由注册信息构建路由表，调用者需持有mutex_
+        std::shared_ptr<const RouteTable> build() const;
+        void publish(std::shared_ptr<const RouteTable> table) const;
+
+        // 当前线程可见的路由表，版本号未变化时直接返回线程缓存中本Router的路由表
+        const std::shared_ptr<const RouteTable> &table() const;
+
+        // 提取路径参数，以模式中声明的名字（如/user/:id中的id）作为键
+        // 参数值只记录在请求路径中的偏移，不产生拷贝
+        static void extractPathParameters(const RouteTrie::Match &match,
+                                          const std::vector<std::string> &names,
+                                          HttpRequest &request)
         {
-            // Assuming the first match is the full path, parameters start from index 1
-            for (size_t i = 1; i < match.size(); ++i)
+            request.clearPathParameters();
+            for (size_t i = 0; i < match.count; ++i)
             {
-                request.setPathParameters("param" + std::to_string(i), match[i].str());
+                // 每次重新取路径视图，setPathParameters可能使请求的存储区扩容
+                const RouteTrie::Capture &capture = match.captures[i];
+                request.setPathParameters(names[i], request.path().substr(capture.offset, capture.length));
             }
         }
 
     private:
-        struct RouteCallbackObj
+        // 注册的动态路由
+        struct DynamicRoute
         {
             HttpRequest::Method method_;
-            std::regex pathRegex_;
-            HandlerCallback callback_;
-            RouteCallbackObj(HttpRequest::Method method, std::regex pathRegex, const HandlerCallback &callback)
-                : method_(method), pathRegex_(pathRegex), callback_(callback) {}
+            std::string         pattern_;
+            InlineHandler       handler_;
         };
 
-        // 动态路由处理器对象
-        // 请求方法（get post） + 正则表达式路径 + 方法处理器指针
-        // 由addRoute方法从httpserver添加
-        struct RouteHandlerObj
-        {
-            HttpRequest::Method method_;
-            std::regex pathRegex_;
-            HandlerPtr handler_;
-            RouteHandlerObj(HttpRequest::Method method, std::regex pathRegex, HandlerPtr handler)
-                : method_(method), pathRegex_(pathRegex), handler_(handler) {}
-        };
+        // 注册信息，只在注册与编译时访问
+        mutable std::mutex                                          mutex_;
+        std::unordered_map<RouteKey, InlineHandler, RouteKeyHash>   routes_;        // 精准匹配
+        std::vector<DynamicRoute>                                   dynamicRoutes_; // 按注册顺序存放
+        std::unordered_map<RouteKey, StreamingHandler, RouteKeyHash> streamingHandlers_; // 流式请求体，精准匹配
+
+        bool                                                        metricsEnabled_ = true;
+        mutable RouteMetrics                                        metrics_;
 
-        std::unordered_map<RouteKey, HandlerPtr, RouteKeyHash>      handlers_;       // 精准匹配
-        std::unordered_map<RouteKey, HandlerCallback, RouteKeyHash> callbacks_; // 精准匹配
-        std::vector<RouteHandlerObj>                                regexHandlers_;     // 正则匹配
-        std::vector<RouteCallbackObj>                               regexCallbacks_;   // 正则匹配
+        // 已发布的路由表，只通过std::atomic_load/std::atomic_store访问
+        mutable std::shared_ptr<const RouteTable> table_;
+        mutable std::atomic<uint64_t>             version_{0};
     };
 }
\ No newline at end of file
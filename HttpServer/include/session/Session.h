@@ -1,6 +1,8 @@
 #pragma once
 
 
+#include <atomic>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -21,6 +23,10 @@ namespace tinyHttp
         bool isExpired() const;
         void refresh(); // 刷新过期时间
 
+        // 过期时间点（自纪元起的毫秒数），可与refresh()并发读取，供存储的后台清理使用
+        int64_t expiryMillis() const
+        { return expiryTime_.load(std::memory_order_relaxed); }
+
         void setManager(SessionManager* sessionManager)
         { sessionManager_ = sessionManager; }
 
@@ -35,7 +41,7 @@ namespace tinyHttp
     private:
         std::string                                  sessionId_;
         std::unordered_map<std::string, std::string> data_;
-        std::chrono::system_clock::time_point        expiryTime_;
+        std::atomic<int64_t>                         expiryTime_; // 过期时间点（毫秒）
         int                                          maxAge_; // 过期时间（秒）
         SessionManager*                              sessionManager_;
     };
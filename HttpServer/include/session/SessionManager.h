@@ -4,7 +4,9 @@
 #include "../http/HttpRequest.h"
 #include "../http/HttpResponse.h"
 #include <memory>
+#include <mutex>
 #include <random>
+#include <muduo/net/EventLoop.h>
 
 namespace tinyHttp
 {
@@ -19,8 +21,11 @@ namespace tinyHttp
         // 销毁会话
         void destroySession(const std::string& sessionId);
 
-        // 清理过期会话
-        void cleanExpiredSessions();
+        // 清理过期会话，返回清理的数量
+        size_t cleanExpiredSessions();
+
+        // 在loop上每隔interval秒清理一次过期会话，SessionManager需比loop活得更久
+        void startCleanup(muduo::net::EventLoop* loop, double interval = 1.0);
 
         // 更新会话
         void updateSession(std::shared_ptr<Session> session)
@@ -36,6 +41,7 @@ namespace tinyHttp
         static void setSessionCookie(const std::string& sessionId, HttpResponse* resp);
 
         std::unique_ptr<SessionStorage> storage_;
+        std::mutex   rngMutex_; // getSession在各I/O线程中调用，生成id时保护rng_
         std::mt19937 rng_; // 用于生成随机会话id
     };
 }
\ No newline at end of file
@@ -1,6 +1,12 @@
 #pragma once
 #include "Session.h"
+#include <chrono>
+#include <cstdint>
 #include <memory>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 
 namespace tinyHttp
@@ -12,16 +18,55 @@ namespace tinyHttp
         virtual void save(std::shared_ptr<Session> session) = 0;
         virtual std::shared_ptr<Session> load(const std::string& sessionId) = 0;
         virtual void remove(const std::string& sessionId) = 0;
+        // 清理已过期的会话，返回清理的数量；自行处理过期的存储（如带TTL的外部存储）无需实现
+        virtual size_t removeExpired() { return 0; }
     };
 
     // 基于内存的会话存储实现
+    // 会话按id哈希分布在多个分段中，各分段独立加锁；已存在会话的加载与保存只持有所在分段的读锁，
+    // 不同I/O线程之间基本没有竞争。过期清理使用分段内的时间轮：每个会话按过期时间挂在对应刻度的槽上，
+    // 推进时间轮时只检查到期槽中的会话，被刷新过的会话按新的过期时间重新挂入，不需要遍历全部会话
     class MemorySessionStorage : public SessionStorage
     {
     public:
+        static constexpr size_t kShards = 32;
+        static constexpr size_t kWheelSlots = 512;
+
+        // tick为时间轮的刻度，会话在过期后的下一个刻度被清理
+        explicit MemorySessionStorage(std::chrono::milliseconds tick = std::chrono::seconds(1));
+
         void save(std::shared_ptr<Session> session) override;
         std::shared_ptr<Session> load(const std::string& sessionId) override;
         void remove(const std::string& sessionId) override;
+        size_t removeExpired() override;
+
+        // 将时间轮推进到nowMillis（自纪元起的毫秒数），返回清理的数量
+        size_t removeExpired(int64_t nowMillis);
+
+        size_t size() const;
+
     private:
-        std::unordered_map<std::string, std::shared_ptr<Session>> sessions_;
+        struct Entry
+        {
+            std::shared_ptr<Session> session;
+            int64_t                  tick = 0; // 会话在时间轮中所挂的刻度
+        };
+
+        struct Shard
+        {
+            mutable std::shared_mutex                    mutex;
+            std::unordered_map<std::string, Entry>       sessions;
+            std::vector<std::vector<std::string>>        wheel;      // 第t个刻度到期的会话id挂在wheel[t % kWheelSlots]
+            int64_t                                      sweptTick;  // 已推进到的刻度
+        };
+
+        // 按会话当前的过期时间挂入时间轮，调用方需持有分段的写锁
+        void schedule(Shard& shard, const std::string& sessionId, Entry& entry);
+
+        Shard& shardOf(const std::string& sessionId)
+        { return shards_[std::hash<std::string>{}(sessionId) % kShards]; }
+
+        const int64_t tickMillis_;
+        Shard         shards_[kShards];
     };
-}
\ No newline at end of file
+}
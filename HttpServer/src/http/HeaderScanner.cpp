@@ -0,0 +1,146 @@
+#include "http/HeaderScanner.h"
+
+#if defined(__SSE2__) || (defined(__x86_64__) && defined(__GNUC__))
+#include <immintrin.h>
+#endif
+
+namespace tinyHttp
+{
+    namespace
+    {
+#if defined(__x86_64__) && defined(__GNUC__)
+        // 启动时检测一次CPU是否支持AVX2
+        bool detectAvx2()
+        {
+            __builtin_cpu_init();
+            return __builtin_cpu_supports("avx2");
+        }
+
+        const bool kHasAvx2 = detectAvx2();
+#endif
+    }
+
+    bool HeaderScanner::scan(const char* data, size_t len)
+    {
+        if (done())
+        {
+            return true;
+        }
+#if defined(__x86_64__) && defined(__GNUC__)
+        if (kHasAvx2)
+        {
+            scanAvx2(data, len);
+            return done();
+        }
+#endif
+#if defined(__SSE2__)
+        scanSse2(data, len);
+#else
+        scanScalar(data, len);
+#endif
+        return done();
+    }
+
+    bool HeaderScanner::onDelimiter(const char* data, size_t len, size_t pos)
+    {
+        if (data[pos] == ':')
+        {
+            if (colon_ == kNoColon)
+            {
+                colon_ = static_cast<uint32_t>(pos);
+            }
+            return true;
+        }
+
+        // '\r'：需要看到下一个字节才能确定是否为CRLF
+        if (pos + 1 >= len)
+        {
+            scanned_ = pos; // 下次从这个'\r'重新开始
+            return false;
+        }
+        if (data[pos + 1] != '\n')
+        {
+            return true; // 单独的'\r'按普通字符处理
+        }
+
+        if (pos == lineBegin_)
+        {
+            // 空行，请求头结束
+            blockSize_ = pos + 2;
+            scanned_ = blockSize_;
+            return false;
+        }
+        const auto end = static_cast<uint32_t>(pos);
+        lines_.push_back(Line{lineBegin_, colon_ == kNoColon ? end : colon_, end});
+        lineBegin_ = end + 2;
+        colon_ = kNoColon;
+        return true;
+    }
+
+    bool HeaderScanner::scanScalar(const char* data, size_t len)
+    {
+        for (size_t i = scanned_; i < len; ++i)
+        {
+            if ((data[i] == '\r' || data[i] == ':') && !onDelimiter(data, len, i))
+            {
+                return false;
+            }
+        }
+        scanned_ = len;
+        return true;
+    }
+
+#if defined(__SSE2__)
+    bool HeaderScanner::scanSse2(const char* data, size_t len)
+    {
+        const __m128i cr = _mm_set1_epi8('\r');
+        const __m128i colon = _mm_set1_epi8(':');
+        size_t i = scanned_;
+        for (; i + 16 <= len; i += 16)
+        {
+            const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+            auto mask = static_cast<unsigned>(_mm_movemask_epi8(
+                _mm_or_si128(_mm_cmpeq_epi8(chunk, cr), _mm_cmpeq_epi8(chunk, colon))));
+            // 按位置从低到高处理命中的分隔符
+            while (mask)
+            {
+                const size_t pos = i + __builtin_ctz(mask);
+                mask &= mask - 1;
+                if (!onDelimiter(data, len, pos))
+                {
+                    return false;
+                }
+            }
+        }
+        scanned_ = i;
+        return scanScalar(data, len); // 不足16字节的尾部
+    }
+#endif
+
+#if defined(__x86_64__) && defined(__GNUC__)
+    __attribute__((target("avx2")))
+    bool HeaderScanner::scanAvx2(const char* data, size_t len)
+    {
+        const __m256i cr = _mm256_set1_epi8('\r');
+        const __m256i colon = _mm256_set1_epi8(':');
+        size_t i = scanned_;
+        for (; i + 32 <= len; i += 32)
+        {
+            const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i));
+            auto mask = static_cast<unsigned>(_mm256_movemask_epi8(
+                _mm256_or_si256(_mm256_cmpeq_epi8(chunk, cr), _mm256_cmpeq_epi8(chunk, colon))));
+            while (mask)
+            {
+                const size_t pos = i + __builtin_ctz(mask);
+                mask &= mask - 1;
+                if (!onDelimiter(data, len, pos))
+                {
+                    return false;
+                }
+            }
+        }
+        scanned_ = i;
+        return scanScalar(data, len); // 不足32字节的尾部
+    }
+#endif
+}
@@ -1,6 +1,6 @@
 #include "http/HttpContext.h"
 
-#include <regex>
+#include <charconv>
 
 /*
 POST /api/login?debug=1 HTTP/1.1\r\n
@@ -11,140 +11,360 @@ Content-Length: 27\r\n
 username=admin&password=123456
 */
 
-// 解析HTTP请求报文
-bool HttpContext::parseRequest(muduo::net::Buffer* buf, muduo::Timestamp receiveTime)
+namespace tinyHttp
 {
-    // 解析请求行
-    const char *crlf = buf->findCRLF();
-    if (crlf)
+    // 解析HTTP请求报文
+    // 每解析完一部分就从buf中取走对应字节，未完整到达的部分留在buf中等待下一次调用
+    bool HttpContext::parseRequest(muduo::net::Buffer* buf, muduo::Timestamp receiveTime)
     {
-        if (!processRequestLine(buf->peek(), crlf))
+        bool hasMore = true;
+        while (hasMore)
         {
-            return false;
+            if (state_ == kExpectRequestLine)
+            {
+                // 解析请求行
+                const char* crlf = findCRLF(buf);
+                if (!crlf)
+                {
+                    if (buf->readableBytes() > kMaxRequestLineSize)
+                    {
+                        LOG_ERROR << "Request line too long";
+                        return false;
+                    }
+                    break; // 请求行不完整
+                }
+                if (static_cast<size_t>(crlf - buf->peek()) > kMaxRequestLineSize)
+                {
+                    LOG_ERROR << "Request line too long";
+                    return false;
+                }
+                if (!processRequestLine(buf->peek(), crlf))
+                {
+                    return false;
+                }
+                request_.setReceiveTime(receiveTime);
+                buf->retrieveUntil(crlf + 2); // 移动读指针
+                scanned_ = 0;
+                state_ = kExpectHeaders;
+            }
+            else if (state_ == kExpectHeaders)
+            {
+                // 一次扫描索引整个请求头块的CRLF和':'，请求头不完整时记录扫描进度等待更多数据
+                // 大小限制对完整到达的请求头块同样适用，超长的请求头可能在一次读取中全部到达
+                const bool complete = headerScanner_.scan(buf->peek(), buf->readableBytes());
+                if (headerScanner_.scannedBytes() > kMaxHeaderSize)
+                {
+                    LOG_ERROR << "Request headers too large";
+                    return false;
+                }
+                if (!complete)
+                {
+                    break;
+                }
+                // 请求头块整体拷贝一次进请求的头部容器，各字段只记录偏移
+                const char* block = request_.appendRawHeaders(buf->peek(), buf->peek() + headerScanner_.blockSize());
+                if (!processHeaders(block))
+                {
+                    return false;
+                }
+                buf->retrieve(headerScanner_.blockSize());
+                headerScanner_.reset();
+                if (headersCallback_)
+                {
+                    headersCallback_(this);
+                }
+                // 根据Transfer-Encoding和Content-Length决定请求体的读取方式
+                if (!beginBody())
+                {
+                    return false;
+                }
+            }
+            else if (state_ == kExpectBody)
+            {
+                // 请求体可能分多次到达，每次只取走已到达的部分
+                const uint64_t remaining = request_.contentLength() - bodyReceived_;
+                const size_t n = static_cast<size_t>(std::min<uint64_t>(remaining, buf->readableBytes()));
+                buf->retrieve(deliverBody(buf->peek(), n));
+                if (bodyReceived_ == request_.contentLength())
+                {
+                    state_ = kGotAll;
+                }
+                else
+                {
+                    hasMore = false; // 请求体不完整或sink暂停接收
+                }
+            }
+            else if (state_ == kExpectChunkSize)
+            {
+                // 块大小行："1a2b;ext=value\r\n"
+                const char* crlf = findCRLF(buf);
+                if (!crlf)
+                {
+                    if (buf->readableBytes() > kMaxChunkLineSize)
+                    {
+                        LOG_ERROR << "Chunk size line too long";
+                        return false;
+                    }
+                    break;
+                }
+                if (!processChunkSize(buf->peek(), crlf))
+                {
+                    return false;
+                }
+                buf->retrieveUntil(crlf + 2);
+                scanned_ = 0;
+                state_ = chunkRemaining_ > 0 ? kExpectChunkData : kExpectTrailers;
+            }
+            else if (state_ == kExpectChunkData)
+            {
+                // 块数据可能跨多个TCP分段，边到达边追加到请求体
+                const size_t n = static_cast<size_t>(std::min<uint64_t>(chunkRemaining_, buf->readableBytes()));
+                const size_t consumed = deliverBody(buf->peek(), n);
+                buf->retrieve(consumed);
+                chunkRemaining_ -= consumed;
+                if (chunkRemaining_ > 0)
+                {
+                    break;
+                }
+                state_ = kExpectChunkCRLF;
+            }
+            else if (state_ == kExpectChunkCRLF)
+            {
+                // 每块数据后紧跟一个CRLF
+                if (buf->readableBytes() < 2)
+                {
+                    break;
+                }
+                if (buf->peek()[0] != '\r' || buf->peek()[1] != '\n')
+                {
+                    LOG_ERROR << "Missing CRLF after chunk data";
+                    return false;
+                }
+                buf->retrieve(2);
+                state_ = kExpectChunkSize;
+            }
+            else if (state_ == kExpectTrailers)
+            {
+                // 最后一块之后是可选的trailer头部，以空行结束，全部trailer合计不超过请求头的大小上限
+                const char* crlf = findCRLF(buf);
+                if (!crlf)
+                {
+                    if (buf->readableBytes() > kMaxHeaderSize - trailerBytes_)
+                    {
+                        LOG_ERROR << "Chunked trailers too large";
+                        return false;
+                    }
+                    break;
+                }
+                trailerBytes_ += crlf + 2 - buf->peek();
+                if (trailerBytes_ > kMaxHeaderSize)
+                {
+                    LOG_ERROR << "Chunked trailers too large";
+                    return false;
+                }
+                if (crlf != buf->peek())
+                {
+                    const char* colon = std::find(buf->peek(), crlf, ':');
+                    if (colon == crlf)
+                    {
+                        LOG_ERROR << "Invalid Trailer Line";
+                        return false;
+                    }
+                    // 分帧字段与Host不允许出现在trailer中，直接丢弃，以免改写已确定的请求体长度
+                    const HeaderId id = HttpHeaders::idOf(std::string_view(buf->peek(), colon - buf->peek()));
+                    if (id != HeaderId::kContentLength && id != HeaderId::kTransferEncoding && id != HeaderId::kHost)
+                    {
+                        const char* line = request_.appendRawHeaders(buf->peek(), crlf);
+                        if (!request_.addHeader(line, line + (colon - buf->peek()), line + (crlf - buf->peek())))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                else
+                {
+                    // 解码完成，以实际长度作为请求体长度
+                    request_.setContentLength(bodyReceived_);
+                    state_ = kGotAll;
+                }
+                buf->retrieveUntil(crlf + 2);
+                scanned_ = 0;
+            }
+            else
+            {
+                hasMore = false; // kGotAll，多余的字节属于下一个请求，留在buf中
+            }
+        }
+
+        // 最后request自校验
+        if (state_ == kGotAll)
+        {
+            return request_.selfCheck();
         }
-        buf->retrieveUntil(crlf + 2); // 移动读指针
-        request_.setReceiveTime(receiveTime);
+        return true;
     }
-    else
+
+    const char* HttpContext::findCRLF(const muduo::net::Buffer* buf)
     {
-        return false; // 请求行不完整
+        const char* crlf = buf->findCRLF(buf->peek() + scanned_);
+        if (!crlf)
+        {
+            // 末尾的'\r'可能与下一批数据开头的'\n'组成CRLF，因此保留最后一个字节下次重新检查
+            const size_t readable = buf->readableBytes();
+            scanned_ = readable > 0 ? readable - 1 : 0;
+        }
+        return crlf;
     }
 
-    // 解析请求头 请求头的最后有两个crlf字符
-    // 记录上一个CRLF位置
-    const char* preCRLF = buf->findCRLF();
-    while (preCRLF && preCRLF + 2 <= buf->peek() + buf->readableBytes())
+    // 解析请求行
+    bool HttpContext::processRequestLine(const char* begin, const char* end)
     {
-        const char* nextCRLF = buf->findCRLF(preCRLF + 2);
-        if (nextCRLF == preCRLF + 2)
+        // 请求行整体拷贝一次进请求的存储区，方法、路径、查询参数、版本都只记录偏移
+        const char* line = request_.appendRaw(begin, end);
+        end = line + (end - begin);
+        begin = line;
+
+        // 解析请求类型、路径、路径参数、HTTP版本
+        // 按照空格分割，找到第一个空格位置作为请求类型的end
+        const char* space = std::find(begin, end, ' ');
+        if (space == end)
+        {
+            LOG_ERROR << "Invalid RequestLine";
+            return false;
+        }
+        // 设置请求方法
+        if (!request_.setMethod(begin, space))
+        {
+            LOG_ERROR << "Invalid Method";
+            return false;
+        }
+        // 移动起始指针
+        const char* pathBegin = space + 1;
+        space = std::find(pathBegin, end, ' ');
+        const char* argumentBegin = std::find(pathBegin, space, '?');
+        if (space == end)
         {
-            // 找到连续空行，解析请求头
-            if (!processHeaders(buf->peek(), nextCRLF))
+            LOG_ERROR << "Invalid RequestLine";
+            return false;
+        }
+        // 设置请求路径
+        request_.setPath(pathBegin, argumentBegin);
+        // 设置查询参数
+        if (argumentBegin != space)
+        {
+            request_.setQueryParameters(argumentBegin + 1, space);
+        }
+        // 检查HTTP版本格式
+        const std::string_view version(space + 1, end - space - 1);
+        if (version != "HTTP/1.1" && version != "HTTP/1.0")
+        {
+            LOG_ERROR << "Invalid HTTP Version";
+            return false;
+        }
+        // 设置HTTP版本
+        request_.setVersion(version);
+        return true;
+    }
+
+    // 按扫描得到的索引解析请求头，block指向请求头块起始位置
+    bool HttpContext::processHeaders(const char* block)
+    {
+        for (const auto& line : headerScanner_.lines())
+        {
+            if (line.colon == line.end)
+            {
+                LOG_ERROR << "Invalid Header Line";
+                return false;
+            }
+            if (!request_.addHeader(block + line.begin, block + line.colon, block + line.end))
             {
                 return false;
             }
-            buf->retrieveUntil(nextCRLF + 2);
-            break;
         }
-        preCRLF = nextCRLF;
+        return true;
     }
 
-    // 解析请求体
-    if (buf->readableBytes() > 0)
+    bool HttpContext::beginBody()
     {
-        // 读取剩余的请求体数据
-        if (buf->readableBytes() < request_.contentLength())
+        const std::string_view encoding = request_.getHeader(HeaderId::kTransferEncoding);
+        if (!encoding.empty())
         {
-            LOG_ERROR << "Buffer overflow: Body length less than Content-Length";
+            // Transfer-Encoding优先于Content-Length，且chunked必须是最后一个编码
+            if (!isChunked(encoding))
+            {
+                LOG_ERROR << "Unsupported Transfer-Encoding: " << std::string(encoding);
+                return false;
+            }
+            request_.setContentLength(0);
+            chunkRemaining_ = 0;
+            state_ = kExpectChunkSize;
+            return true;
+        }
+        if (request_.contentLength() > bodyLimit_)
+        {
+            LOG_ERROR << "Request body too large: " << request_.contentLength();
             return false;
         }
-
-        // 只读取 Content-Length 指定的长度
-        auto body = std::string(buf->peek(), buf->peek() + request_.contentLength());
-        request_.setBody(body);
-        buf->retrieve(request_.contentLength());
+        state_ = request_.contentLength() > 0 ? kExpectBody : kGotAll;
+        return true;
     }
 
-    // 最后request自校验
-    complete_ =  request_.selfCheck();
-    return complete_;
-}
-
-// 解析请求行
-bool HttpContext::processRequestLine(const char* begin, const char* end)
-{
-    // 解析请求类型、路径、路径参数、HTTP版本
-    // 按照空格分割，找到第一个空格位置作为请求类型的end
-    const char* space = std::find(begin, end, ' ');
-    if (space == end)
-    {
-        LOG_ERROR << "Invalid RequestLine";
-        return false;
-    }
-    // 设置请求方法
-    request_.setMethod(begin, space);
-    // 移动起始指针
-    const char* pathBegin = space + 1;
-    space = std::find(pathBegin, end, ' ');
-    const char* argumentBegin = std::find(pathBegin, space, '?');
-    if (space == end)
-    {
-        LOG_ERROR << "Invalid RequestLine";
-        return false;
-    }
-    // 设置请求路径
-    request_.setPath(pathBegin, argumentBegin);
-    // 设置查询参数
-    if (argumentBegin != space)
-    {
-        request_.setQueryParameters(argumentBegin + 1, space);
-    }
-    const char* versionBegin = space + 1;
-    // 检查HTTP版本格式
-    if (std::string(versionBegin, end) != "HTTP/1.1" &&
-        std::string(versionBegin, end) != "HTTP/1.0")
+    bool HttpContext::isChunked(std::string_view encoding)
     {
-        LOG_ERROR << "Invalid HTTP Version";
-        return false;
+        const size_t comma = encoding.rfind(',');
+        std::string_view last = comma == std::string_view::npos ? encoding : encoding.substr(comma + 1);
+        while (!last.empty() && (last.front() == ' ' || last.front() == '\t'))
+        {
+            last.remove_prefix(1);
+        }
+        while (!last.empty() && (last.back() == ' ' || last.back() == '\t'))
+        {
+            last.remove_suffix(1);
+        }
+        return HttpHeaders::equalsIgnoreCase(last, "chunked");
     }
-    // 设置HTTP版本
-    request_.setVersion(std::string(versionBegin, end));
-    return true;
-}
 
-// 解析请求头
-bool HttpContext::processHeaders(const char* begin, const char* end)
-{
-    // 请求头格式 "sentence/r/n sentence/r/n"
-    // 每次处理/r/n前面的部分
-    const char* lineStart = begin;
-    while (lineStart < end)
+    // 解析块大小行，忽略块扩展参数
+    bool HttpContext::processChunkSize(const char* begin, const char* end)
     {
-        const char* lineEnd = std::find(lineStart, end, '\r');
-        if (lineEnd == end || lineEnd + 1 == end || *(lineEnd + 1) != '\n')
+        const char* sizeEnd = std::find(begin, end, ';');
+        while (sizeEnd > begin && (*(sizeEnd - 1) == ' ' || *(sizeEnd - 1) == '\t'))
+        {
+            --sizeEnd;
+        }
+        uint64_t size = 0;
+        const auto result = std::from_chars(begin, sizeEnd, size, 16);
+        if (result.ec != std::errc() || result.ptr != sizeEnd)
         {
-            LOG_ERROR << "Invalid Header Line";
+            LOG_ERROR << "Invalid chunk size: " << std::string(begin, end);
             return false;
         }
-        // 解析单个请求头
-        request_.addHeader(lineStart, lineEnd);
-        // 移动到下一行
-        lineStart = lineEnd + 2;
+        if (size > bodyLimit_ - bodyReceived_)
+        {
+            LOG_ERROR << "Chunked request body too large";
+            return false;
+        }
+        chunkRemaining_ = size;
+        return true;
     }
-    return true;
-}
 
-// 解析请求体，get和delete方法一般没有body
-bool HttpContext::processBody(const char* begin, const char* end)
-{
-    // 直接设置请求体内容
-    try
-    {
-        request_.setBody(begin, end);
-    }
-    catch (const std::exception& e)
+    size_t HttpContext::deliverBody(const char* data, size_t len)
     {
-        LOG_ERROR << "Invalid Request Body " << e.what();
+        if (len == 0)
+        {
+            return 0;
+        }
+        size_t consumed = len;
+        if (bodySink_)
+        {
+            consumed = std::min(bodySink_(request_, data, len), len);
+            bodyPaused_ = consumed < len;
+        }
+        else
+        {
+            request_.appendBody(data, data + len);
+        }
+        bodyReceived_ += consumed;
+        return consumed;
     }
-    return true;
-}
\ No newline at end of file
+}
@@ -0,0 +1,217 @@
+#include "http/HttpHeaders.h"
+
+#include <functional>
+
+namespace tinyHttp
+{
+    namespace
+    {
+        inline char toLower(char c)
+        {
+            return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+        }
+    }
+
+    bool HttpHeaders::equalsIgnoreCase(std::string_view a, std::string_view b)
+    {
+        if (a.size() != b.size())
+        {
+            return false;
+        }
+        for (size_t i = 0; i < a.size(); ++i)
+        {
+            if (toLower(a[i]) != toLower(b[i]))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // 常用字段的哈希值在编译期算出，按哈希分派后再确认一次字段名
+    HeaderId HttpHeaders::idOf(std::string_view name, uint32_t h)
+    {
+        HeaderId id = HeaderId::kUnknown;
+        std::string_view expected;
+        switch (h)
+        {
+        case hash("host"):              id = HeaderId::kHost;             expected = "host"; break;
+        case hash("content-length"):    id = HeaderId::kContentLength;    expected = "content-length"; break;
+        case hash("content-type"):      id = HeaderId::kContentType;      expected = "content-type"; break;
+        case hash("connection"):        id = HeaderId::kConnection;       expected = "connection"; break;
+        case hash("cookie"):            id = HeaderId::kCookie;           expected = "cookie"; break;
+        case hash("set-cookie"):        id = HeaderId::kSetCookie;        expected = "set-cookie"; break;
+        case hash("transfer-encoding"): id = HeaderId::kTransferEncoding; expected = "transfer-encoding"; break;
+        case hash("accept-encoding"):   id = HeaderId::kAcceptEncoding;   expected = "accept-encoding"; break;
+        case hash("content-encoding"):  id = HeaderId::kContentEncoding;  expected = "content-encoding"; break;
+        case hash("user-agent"):        id = HeaderId::kUserAgent;        expected = "user-agent"; break;
+        case hash("accept"):            id = HeaderId::kAccept;           expected = "accept"; break;
+        case hash("cache-control"):     id = HeaderId::kCacheControl;     expected = "cache-control"; break;
+        case hash("if-modified-since"): id = HeaderId::kIfModifiedSince;  expected = "if-modified-since"; break;
+        case hash("if-none-match"):     id = HeaderId::kIfNoneMatch;      expected = "if-none-match"; break;
+        case hash("range"):             id = HeaderId::kRange;            expected = "range"; break;
+        default: return HeaderId::kUnknown;
+        }
+        return equalsIgnoreCase(name, expected) ? id : HeaderId::kUnknown;
+    }
+
+    const char* HttpHeaders::appendRaw(const char* start, const char* end)
+    {
+        const size_t offset = buf_.size();
+        buf_.append(start, end);
+        return buf_.data() + offset;
+    }
+
+    bool HttpHeaders::contains(std::string_view data) const
+    {
+        const std::less<const char*> before;
+        const char* bufBegin = buf_.data();
+        const char* bufEnd = bufBegin + buf_.size();
+        return !before(data.data(), bufBegin) && !before(bufEnd, data.data() + data.size());
+    }
+
+    HttpHeaders::Slice HttpHeaders::store(std::string_view data)
+    {
+        if (contains(data))
+        {
+            return Slice{static_cast<uint32_t>(data.data() - buf_.data()), static_cast<uint32_t>(data.size())};
+        }
+        const auto offset = static_cast<uint32_t>(buf_.size());
+        buf_.append(data.data(), data.size());
+        return Slice{offset, static_cast<uint32_t>(data.size())};
+    }
+
+    HeaderId HttpHeaders::add(std::string_view name, std::string_view value)
+    {
+        Entry e;
+        e.hash = hash(name);
+        e.id = idOf(name, e.hash);
+        // store追加数据时buf_可能扩容，先记录已位于buf_中的那一个，避免其视图失效
+        if (contains(value))
+        {
+            e.value = store(value);
+            e.name = store(name);
+        }
+        else
+        {
+            e.name = store(name);
+            e.value = store(value);
+        }
+
+        if (size_ < kInlineCapacity)
+        {
+            inline_[size_] = e;
+        }
+        else
+        {
+            overflow_.push_back(e);
+        }
+        ++size_;
+        if (e.id != HeaderId::kUnknown)
+        {
+            known_[static_cast<size_t>(e.id)] = static_cast<uint32_t>(size_);
+        }
+        return e.id;
+    }
+
+    void HttpHeaders::set(std::string_view name, std::string_view value)
+    {
+        const size_t i = find(name, hash(name));
+        if (i == kNotFound)
+        {
+            add(name, value);
+            return;
+        }
+        entry(i).value = store(value);
+    }
+
+    void HttpHeaders::remove(std::string_view name)
+    {
+        const uint32_t h = hash(name);
+        size_t kept = 0;
+        for (size_t i = 0; i < size_; ++i)
+        {
+            const Entry& e = entry(i);
+            if (e.hash == h && equalsIgnoreCase(view(e.name), name))
+            {
+                continue;
+            }
+            entry(kept++) = e;
+        }
+        if (kept == size_)
+        {
+            return;
+        }
+        size_ = kept;
+        if (size_ <= kInlineCapacity)
+        {
+            overflow_.clear();
+        }
+        else
+        {
+            overflow_.resize(size_ - kInlineCapacity);
+        }
+        reindex();
+    }
+
+    std::string_view HttpHeaders::get(std::string_view name) const
+    {
+        const size_t i = find(name, hash(name));
+        return i == kNotFound ? std::string_view() : view(entry(i).value);
+    }
+
+    std::string_view HttpHeaders::get(HeaderId id) const
+    {
+        const uint32_t pos = known_[static_cast<size_t>(id)];
+        return pos == 0 ? std::string_view() : view(entry(pos - 1).value);
+    }
+
+    size_t HttpHeaders::find(std::string_view name, uint32_t h) const
+    {
+        const HeaderId id = idOf(name, h);
+        if (id != HeaderId::kUnknown)
+        {
+            const uint32_t pos = known_[static_cast<size_t>(id)];
+            return pos == 0 ? kNotFound : pos - 1;
+        }
+        for (size_t i = size_; i > 0; --i)
+        {
+            const Entry& e = entry(i - 1);
+            if (e.hash == h && equalsIgnoreCase(view(e.name), name))
+            {
+                return i - 1;
+            }
+        }
+        return kNotFound;
+    }
+
+    void HttpHeaders::reindex()
+    {
+        known_.fill(0);
+        for (size_t i = 0; i < size_; ++i)
+        {
+            const HeaderId id = entry(i).id;
+            if (id != HeaderId::kUnknown)
+            {
+                known_[static_cast<size_t>(id)] = static_cast<uint32_t>(i + 1);
+            }
+        }
+    }
+
+    void HttpHeaders::clear()
+    {
+        buf_.clear();
+        overflow_.clear();
+        size_ = 0;
+        known_.fill(0);
+    }
+
+    void HttpHeaders::swap(HttpHeaders& that) noexcept
+    {
+        buf_.swap(that.buf_);
+        inline_.swap(that.inline_);
+        overflow_.swap(that.overflow_);
+        std::swap(size_, that.size_);
+        known_.swap(that.known_);
+    }
+}
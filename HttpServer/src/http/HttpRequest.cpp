@@ -1,212 +1,331 @@
 #include "http/HttpRequest.h"
 
+#include <charconv>
 #include <muduo/base/Logging.h>
 
-void HttpRequest::setReceiveTime(muduo::Timestamp t)
+namespace tinyHttp
 {
-    // 设置请求接收时间
-    receiveTime_ = t;
-}
+    namespace
+    {
+        // 请求头中允许的空白字符
+        inline bool isBlank(char c)
+        {
+            return c == ' ' || c == '\t';
+        }
 
-void HttpRequest::setPath(const char* start, const char* end)
-{
-    path_ = std::string(start, end);
-}
+        static_assert(HttpRequest::parseMethod("GET") == HttpRequest::kGet, "method table");
+        static_assert(HttpRequest::parseMethod("OPTIONS") == HttpRequest::kOptions, "method table");
+        static_assert(HttpRequest::parseMethod("get") == HttpRequest::kInvalid, "methods are case-sensitive");
+    }
 
-void HttpRequest::setPathParameters(const std::string& key, const std::string& value)
-{
-    pathParameters_[key] = value;
-}
+    void HttpRequest::setReceiveTime(muduo::Timestamp t)
+    {
+        // 设置请求接收时间
+        receiveTime_ = t;
+    }
 
-std::string HttpRequest::getPathParameters(const std::string& key) const
-{
-    auto it = pathParameters_.find(key);
-    if (it != pathParameters_.end())
+    const char* HttpRequest::appendRaw(const char* start, const char* end)
     {
-        return it->second;
+        const size_t offset = arena_.size();
+        arena_.append(start, end);
+        return arena_.data() + offset;
     }
-    return "";
-}
 
-// 通过头尾指针设置查询键值对
-// username=admin&password=123456
-void HttpRequest::setQueryParameters(const char* start, const char* end)
-{
-    std::string qs(start, end);
-    // 构造正则表达式进行键值对匹配
-    std::regex re(R"(([^&=]+)=([^&]*))");
-    const auto itBegin = std::sregex_iterator(qs.begin(), qs.end(), re);
-    const auto itEnd = std::sregex_iterator();
-    for (auto it = itBegin; it != itEnd; ++it) {
-        const std::smatch& m = *it;
-        queryParameters_[m[1]] = m[2];
+    HttpRequest::Slice HttpRequest::store(const char* start, const char* end)
+    {
+        const std::less<const char*> before;
+        const char* arenaBegin = arena_.data();
+        const char* arenaEnd = arenaBegin + arena_.size();
+        // 解析时传入的指针来自appendRaw拷贝的报文，直接记录偏移
+        if (!before(start, arenaBegin) && !before(arenaEnd, end))
+        {
+            return Slice{static_cast<uint32_t>(start - arenaBegin), static_cast<uint32_t>(end - start)};
+        }
+        const auto offset = static_cast<uint32_t>(arena_.size());
+        arena_.append(start, end);
+        return Slice{offset, static_cast<uint32_t>(end - start)};
     }
-}
 
-bool HttpRequest::setMethod(const char* start, const char* end)
-{
-    const std::string method(start, end);
+    std::string_view HttpRequest::find(const std::vector<SlicePair>& pairs, std::string_view key) const
+    {
+        for (auto it = pairs.rbegin(); it != pairs.rend(); ++it)
+        {
+            if (view(it->first) == key)
+            {
+                return view(it->second);
+            }
+        }
+        return {};
+    }
 
-    std::unordered_map<std::string, Method> parseMethods
+    void HttpRequest::setPath(const char* start, const char* end)
     {
-        {"GET", kGet}, {"POST", kPost}, {"DELETE", kDelete},
-        {"PUT", kPut}, {"OPTIONS", kOptions}, {"HEAD", kHead}
-    };
+        path_ = store(start, end);
+    }
 
-    if (const auto it = parseMethods.find(method); it != parseMethods.end())
+    void HttpRequest::setPathParameters(std::string_view key, std::string_view value)
     {
-        method_ = it->second;
-        return true;
+        // store追加数据时arena_可能扩容，值通常是路径的一部分（已位于arena_中），先记录值避免其视图失效
+        Slice valueSlice = store(value.data(), value.data() + value.size());
+        Slice keySlice = store(key.data(), key.data() + key.size());
+        pathParameters_.emplace_back(keySlice, valueSlice);
     }
-    return false;
-}
 
-bool HttpRequest::setMethod(const Method method)
-{
-    if (method >= kGet && method <= kOptions)
+    std::string_view HttpRequest::getPathParameters(std::string_view key) const
     {
-        method_ = method;
-        return true;
+        return find(pathParameters_, key);
     }
-    return false;
-}
 
-std::string HttpRequest::getQueryParameters(const std::string &key) const
-{
-    auto it = queryParameters_.find(key);
-    if (it != queryParameters_.end())
+    // 通过头尾指针设置查询键值对，单次扫描按'&'切分键值对，再按第一个'='切分键和值
+    // username=admin&password=123456
+    void HttpRequest::setQueryParameters(const char* start, const char* end)
     {
-        return it->second;
+        while (start < end)
+        {
+            const char* pairEnd = std::find(start, end, '&');
+            const char* equal = std::find(start, pairEnd, '=');
+            // 跳过没有'='或键为空的片段
+            if (equal != pairEnd && equal != start)
+            {
+                queryParameters_.emplace_back(store(start, equal), store(equal + 1, pairEnd));
+            }
+            start = pairEnd == end ? end : pairEnd + 1;
+        }
     }
-    return "";
-}
 
-void HttpRequest::addHeader(const char* start, const char* end)
-{
-    std::string qs(start, end);
-    // 构造正则表达式进行键值对匹配，只匹配第一个":"
-    std::regex re(R"(([^&:=]+):\s*([^&]*))");
-    std::smatch m;
-    std::regex_search(qs, m, re);
-    headers_[m[1]] = m[2];
+    bool HttpRequest::setMethod(const char* start, const char* end)
+    {
+        const Method method = parseMethod(std::string_view(start, end - start));
+        if (method != kInvalid)
+        {
+            method_ = method;
+            return true;
+        }
+        return false;
+    }
 
-    // 特殊处理Content-Length头
-    if (m[1] == "Content-Length")
+    bool HttpRequest::setMethod(const Method method)
     {
-        contentLength_ = std::stoull(m[2]);
+        if (method >= kGet && method <= kOptions)
+        {
+            method_ = method;
+            return true;
+        }
+        return false;
     }
-}
 
-std::string HttpRequest::getHeader(const std::string& field) const
-{
-    auto it = headers_.find(field);
-    if (it != headers_.end())
+    bool HttpRequest::acceptsEncoding(std::string_view coding) const
     {
-        return it->second;
+        auto trim = [](std::string_view s) {
+            while (!s.empty() && (s.front() == ' ' || s.front() == '\t')) s.remove_prefix(1);
+            while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+            return s;
+        };
+
+        std::string_view rest = headers_.get(HeaderId::kAcceptEncoding);
+        bool wildcard = false;
+        while (!rest.empty())
+        {
+            const size_t comma = rest.find(',');
+            std::string_view token = trim(rest.substr(0, comma));
+            rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+
+            bool rejected = false;
+            const size_t semicolon = token.find(';');
+            if (semicolon != std::string_view::npos)
+            {
+                const std::string_view q = trim(token.substr(semicolon + 1));
+                rejected = q.substr(0, 2) == "q=" && q.find_first_not_of("0.", 2) == std::string_view::npos;
+                token = trim(token.substr(0, semicolon));
+            }
+            // 明确列出的编码优先于"*"
+            if (HttpHeaders::equalsIgnoreCase(token, coding))
+            {
+                return !rejected;
+            }
+            if (token == "*")
+            {
+                wildcard = !rejected;
+            }
+        }
+        return wildcard;
     }
-    return "";
-}
 
-// 交换所有元素
-void HttpRequest::swap(HttpRequest& that) noexcept
-{
-    std::swap(method_, that.method_);
-    std::swap(path_, that.path_);
-    std::swap(queryParameters_, that.queryParameters_);
-    std::swap(pathParameters_, that.pathParameters_);
-    std::swap(headers_, that.headers_);
-    std::swap(contentLength_, that.contentLength_);
-    std::swap(receiveTime_, that.receiveTime_);
-}
+    std::string_view HttpRequest::getQueryParameters(std::string_view key) const
+    {
+        return find(queryParameters_, key);
+    }
 
-void HttpRequest::showDetails() const
-{
-    nlohmann::json j;
-
-    // method -> string
-    auto methodToString = [](Method m) -> std::string {
-        switch (m) {
-        case kGet:     return "GET";
-        case kPost:    return "POST";
-        case kHead:    return "HEAD";
-        case kPut:     return "PUT";
-        case kDelete:  return "DELETE";
-        case kOptions: return "OPTIONS";
-        default:       return "INVALID";
-        }
-    };
-
-    j["method"] = methodToString(method_);
-    j["version"] = version_;
-    j["path"] = path_;
-
-    // pathParameters (unordered_map)
-    nlohmann::json pathParams = nlohmann::json::object();
-    for (const auto &p : pathParameters_) pathParams[p.first] = p.second;
-    j["pathParameters"] = std::move(pathParams);
-
-    // queryParameters (unordered_map)
-    nlohmann::json queryParams = nlohmann::json::object();
-    for (const auto &p : queryParameters_) queryParams[p.first] = p.second;
-    j["queryParameters"] = std::move(queryParams);
-
-    // receiveTime as microseconds since epoch (muduo::Timestamp)
-    j["receiveTime_us"] = static_cast<long long>(receiveTime_.microSecondsSinceEpoch());
-    // headers (std::map)
-    nlohmann::json hdrs = nlohmann::json::object();
-    for (const auto &h : headers_) hdrs[h.first] = h.second;
-    j["headers"] = std::move(hdrs);
-
-    j["content"] = content_;
-    j["contentLength"] = contentLength_;
-
-    LOG_INFO << "HttpRequest Details:\n" << j.dump(4);
-}
+    bool HttpRequest::addHeader(const char* start, const char* end)
+    {
+        return addHeader(start, std::find(start, end, ':'), end);
+    }
 
-// 简单的自检函数，检查必要字段是否存在，比如get和delete没有body，post和put必须有body和content-length > 0 content-Type 为规定值
-bool HttpRequest::selfCheck() const
-{
-    // 检查selfCheckwFunc_是否注册了对应method的检查函数
-    auto it = selfCheckFunc_.find(method_);
-    if (it != selfCheckFunc_.end())
+    bool HttpRequest::addHeader(const char* start, const char* colon, const char* end)
     {
-        return it->second(); // 调用对应的检查函数
+        if (colon == end || colon == start)
+        {
+            return false;
+        }
+        const char* valueBegin = colon + 1;
+        while (valueBegin < end && isBlank(*valueBegin))
+        {
+            ++valueBegin;
+        }
+        const char* valueEnd = end;
+        while (valueEnd > valueBegin && isBlank(*(valueEnd - 1)))
+        {
+            --valueEnd;
+        }
+
+        const std::string_view field(start, colon - start);
+        const std::string_view value(valueBegin, valueEnd - valueBegin);
+        const bool hadContentLength = headers_.has(HeaderId::kContentLength);
+        // 特殊处理Content-Length头，字段名大小写不敏感
+        // 长度无法解析或多个Content-Length取值不一致时无法确定请求体边界，必须拒绝，否则请求体会被当作下一个请求解析
+        if (headers_.add(field, value) == HeaderId::kContentLength)
+        {
+            uint64_t length = 0;
+            const auto result = std::from_chars(valueBegin, valueEnd, length);
+            if (result.ec != std::errc() || result.ptr != valueEnd)
+            {
+                LOG_ERROR << "Invalid Content-Length: " << std::string(valueBegin, valueEnd);
+                return false;
+            }
+            if (hadContentLength && length != contentLength_)
+            {
+                LOG_ERROR << "Conflicting Content-Length: " << contentLength_ << " vs " << length;
+                return false;
+            }
+            contentLength_ = length;
+        }
+        return true;
     }
-    // 如果没有注册对应的检查函数，默认返回true
-    return true;
-}
 
-bool HttpRequest::checkGetLikeMethod() const
-{
-    if (!content_.empty())
+    // 交换所有元素
+    void HttpRequest::swap(HttpRequest& that) noexcept
     {
-        LOG_WARN << "GET request should not have a body.";
-        return false;
+        std::swap(method_, that.method_);
+        std::swap(arena_, that.arena_);
+        std::swap(version_, that.version_);
+        std::swap(path_, that.path_);
+        std::swap(queryParameters_, that.queryParameters_);
+        std::swap(pathParameters_, that.pathParameters_);
+        headers_.swap(that.headers_);
+        std::swap(content_, that.content_);
+        std::swap(contentLength_, that.contentLength_);
+        std::swap(bodyStreamed_, that.bodyStreamed_);
+        std::swap(receiveTime_, that.receiveTime_);
+        std::swap(peerAddress_, that.peerAddress_);
     }
-    return true;
-}
 
-bool HttpRequest::checkPostLikeMethod()
-{
-    if (content_.empty() || contentLength_ == 0)
+    void HttpRequest::clear()
     {
-        LOG_ERROR << "POST request must have a body and Content-Length > 0.";
-        return false;
+        method_ = kInvalid;
+        arena_.clear();
+        version_ = Slice();
+        path_ = Slice();
+        pathParameters_.clear();
+        queryParameters_.clear();
+        receiveTime_ = muduo::Timestamp();
+        headers_.clear();
+        if (content_.capacity() > kMaxRetainedBodyCapacity)
+        {
+            std::string().swap(content_);
+        }
+        else
+        {
+            content_.clear();
+        }
+        contentLength_ = 0;
+        bodyStreamed_ = false;
     }
 
-    auto contentType = getHeader("Content-Type");
-    if (contentType != "application/x-www-form-urlencoded" && contentType != "application/json")
+    void HttpRequest::showDetails() const
     {
-        LOG_ERROR << "Unsupported Content-Type for POST request: " << contentType;
-        return false;
+        nlohmann::json j;
+
+        j["method"] = std::string(methodString(method_));
+        j["version"] = std::string(getVersion());
+        j["path"] = std::string(path());
+
+        nlohmann::json pathParams = nlohmann::json::object();
+        for (const auto &[key, value] : pathParameters_) pathParams[std::string(view(key))] = std::string(view(value));
+        j["pathParameters"] = std::move(pathParams);
+
+        nlohmann::json queryParams = nlohmann::json::object();
+        for (const auto &[key, value] : queryParameters_) queryParams[std::string(view(key))] = std::string(view(value));
+        j["queryParameters"] = std::move(queryParams);
+
+        // receiveTime as microseconds since epoch (muduo::Timestamp)
+        j["receiveTime_us"] = static_cast<long long>(receiveTime_.microSecondsSinceEpoch());
+        nlohmann::json hdrs = nlohmann::json::object();
+        headers_.forEach([&hdrs](std::string_view field, std::string_view value) {
+            hdrs[std::string(field)] = std::string(value);
+        });
+        j["headers"] = std::move(hdrs);
+
+        j["content"] = content_;
+        j["contentLength"] = contentLength_;
+
+        LOG_INFO << "HttpRequest Details:\n" << j.dump(4);
+    }
+
+    // 简单的自检函数，检查必要字段是否存在，比如get和delete没有body，post和put必须有body和content-length > 0 content-Type 为规定值
+    bool HttpRequest::selfCheck()
+    {
+        switch (method_)
+        {
+        case kGet:
+        case kDelete:
+            return checkGetLikeMethod();
+        case kPost:
+        case kPut:
+            return checkPostLikeMethod();
+        default:
+            // 其他方法没有对应的检查函数，默认返回true
+            return true;
+        }
+    }
+
+    bool HttpRequest::checkGetLikeMethod() const
+    {
+        if (!content_.empty())
+        {
+            LOG_WARN << "GET request should not have a body.";
+            return false;
+        }
+        return true;
     }
 
-    // 校验contentLength_是否与content_长度匹配
-    if (contentLength_ != content_.size())
+    bool HttpRequest::checkPostLikeMethod()
     {
-        LOG_WARN << "Content-Length does not match actual content size.";
-        // 优先修正contentLength_
-        contentLength_ = content_.size();
+        // 流式请求体不经过content_，其长度与格式由对应的处理器自行校验
+        if (bodyStreamed_)
+        {
+            return true;
+        }
+
+        if (content_.empty() || contentLength_ == 0)
+        {
+            LOG_ERROR << "POST request must have a body and Content-Length > 0.";
+            return false;
+        }
+
+        const std::string_view contentType = getHeader(HeaderId::kContentType);
+        if (contentType != "application/x-www-form-urlencoded" && contentType != "application/json")
+        {
+            LOG_ERROR << "Unsupported Content-Type for POST request: " << contentType;
+            return false;
+        }
+
+        // 校验contentLength_是否与content_长度匹配
+        if (contentLength_ != content_.size())
+        {
+            LOG_WARN << "Content-Length does not match actual content size.";
+            // 优先修正contentLength_
+            contentLength_ = content_.size();
+        }
+        return true;
     }
-    return true;
-}
\ No newline at end of file
+}
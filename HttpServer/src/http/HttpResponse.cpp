@@ -1,44 +1,127 @@
 #include "../../include/http/HttpResponse.h"
 
-void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf) const
+#include <cstring>
+
+namespace tinyHttp
 {
-    // HttpResponse封装的信息格式化输出
-    char buf[32];
-    // 为什么不把状态信息放入格式化字符串中，因为状态信息有长有短，不方便定义一个固定大小的内存存储
-    snprintf(buf, sizeof buf, "%s %d ", httpVersion_.c_str(), statusCode_);
+    namespace
+    {
+        constexpr std::string_view kCRLF = "\r\n";
+        constexpr std::string_view kHeaderSeparator = ": ";
+        constexpr std::string_view kConnectionClose = "Connection: close\r\n";
+        constexpr std::string_view kConnectionKeepAlive = "Connection: Keep-Alive\r\n";
 
-    outputBuf->append(buf);
-    outputBuf->append(statusMessage_);
-    outputBuf->append("\r\n");
+        // 状态码最多占用的字符数
+        constexpr size_t kMaxStatusCodeDigits = 11;
 
-    if (closeConnection_) // 思考一下这些地方是不是可以直接移入近headers_中
+        inline char* write(char* dest, std::string_view data)
+        {
+            std::memcpy(dest, data.data(), data.size());
+            return dest + data.size();
+        }
+    }
+
+    size_t HttpResponse::headSize() const
     {
-        outputBuf->append("Connection: close\r\n");
+        if (serialized_)
+        {
+            return closeConnection_
+                ? serialized_->size() - kConnectionKeepAlive.size() + kConnectionClose.size()
+                : serialized_->size();
+        }
+
+        char code[kMaxStatusCodeDigits];
+        const size_t codeLength = std::to_chars(code, code + sizeof code, static_cast<int>(statusCode_)).ptr - code;
+
+        // 状态行："HTTP/1.1 200 OK\r\n"
+        size_t size = httpVersion_.size() + 1 + codeLength + 1 + statusMessage().size() + kCRLF.size();
+        size += closeConnection_ ? kConnectionClose.size() : kConnectionKeepAlive.size();
+        for (size_t i = 0; i < headers_.size(); ++i)
+        {
+            size += headers_.name(i).size() + kHeaderSeparator.size() + headers_.value(i).size() + kCRLF.size();
+        }
+        if (rawHeaders_)
+        {
+            size += rawHeaders_->size();
+        }
+        return size + kCRLF.size();
     }
-    else
+
+    void HttpResponse::appendHeadToBuffer(muduo::net::Buffer* outputBuf) const
     {
-        //snprintf(buf, sizeof buf, "Content-Length: %zd\r\n", body_.size());
-        //outputBuf->append(buf);
-        outputBuf->append("Connection: Keep-Alive\r\n");
+        outputBuf->ensureWritableBytes(headSize());
+        // 按实际写入的字节数提交，headSize()与writeHead()不一致时可以从缓冲区长度上发现
+        const char* end = writeHead(outputBuf->beginWrite());
+        outputBuf->hasWritten(end - outputBuf->beginWrite());
     }
 
-    for (const auto& header : headers_)
-    { // 为什么这里不用格式化字符串？因为key和value的长度不定
-        outputBuf->append(header.first);
-        outputBuf->append(": ");
-        outputBuf->append(header.second);
-        outputBuf->append("\r\n");
+    void HttpResponse::appendToBuffer(muduo::net::Buffer* outputBuf) const
+    {
+        if (serialized_ && !closeConnection_)
+        {
+            outputBuf->append(serialized_->data(), serialized_->size());
+            return;
+        }
+        const size_t size = serializedSize();
+        outputBuf->ensureWritableBytes(size);
+        write(writeHead(outputBuf->beginWrite()), body());
+        outputBuf->hasWritten(size);
     }
-    outputBuf->append("\r\n");
 
-    outputBuf->append(body_);
-}
+    std::string HttpResponse::serialize(size_t* connectionOffset)
+    {
+        const bool close = closeConnection_;
+        closeConnection_ = false;
+        std::string bytes(serializedSize(), '\0');
+        write(writeHead(&bytes[0]), serialized_ ? std::string_view() : body());
+        closeConnection_ = close;
+        // Connection头部紧跟在状态行之后
+        *connectionOffset = serialized_ ? serializedConnection_ : bytes.find(kCRLF) + kCRLF.size();
+        return bytes;
+    }
 
-void HttpResponse::setStatusLine(const std::string& version,
-                                 HttpStatusCode statusCode,
-                                 const std::string& statusMessage)
-{
-    httpVersion_ = version;
-    statusCode_ = statusCode;
-    statusMessage_ = statusMessage;
+    char* HttpResponse::writeHead(char* p) const
+    {
+        if (serialized_)
+        {
+            // 缓存的响应：Connection之外的字节原样写出
+            const std::string_view bytes(*serialized_);
+            p = write(p, bytes.substr(0, serializedConnection_));
+            p = write(p, closeConnection_ ? kConnectionClose : kConnectionKeepAlive);
+            return write(p, bytes.substr(serializedConnection_ + kConnectionKeepAlive.size()));
+        }
+
+        // 状态行
+        p = write(p, httpVersion_);
+        *p++ = ' ';
+        p = std::to_chars(p, p + kMaxStatusCodeDigits, static_cast<int>(statusCode_)).ptr;
+        *p++ = ' ';
+        p = write(p, statusMessage());
+        p = write(p, kCRLF);
+
+        // Connection头部由closeConnection_决定，用户设置的Connection头部已在addHeader中转换
+        p = write(p, closeConnection_ ? kConnectionClose : kConnectionKeepAlive);
+
+        for (size_t i = 0; i < headers_.size(); ++i)
+        {
+            p = write(p, headers_.name(i));
+            p = write(p, kHeaderSeparator);
+            p = write(p, headers_.value(i));
+            p = write(p, kCRLF);
+        }
+        if (rawHeaders_)
+        {
+            p = write(p, *rawHeaders_);
+        }
+        return write(p, kCRLF);
+    }
+
+    void HttpResponse::setStatusLine(const std::string& version,
+                                     HttpStatusCode statusCode,
+                                     std::string_view statusMessage)
+    {
+        httpVersion_ = version;
+        statusCode_ = statusCode;
+        setStatusMessage(statusMessage);
+    }
 }
@@ -0,0 +1,276 @@
+#include "http/HttpServer.h"
+
+#include <unistd.h>
+
+#include <boost/any.hpp>
+
+namespace tinyHttp
+{
+    HttpServer::HttpServer(int port,
+                           const std::string& name,
+                           muduo::net::TcpServer::Option option)
+        : listenAddr_(static_cast<uint16_t>(port))
+        , server_(&mainLoop_, listenAddr_, name, option)
+        , maxBodySize_(HttpContext::kDefaultMaxBodySize)
+    {
+        server_.setConnectionCallback(
+            [this](const muduo::net::TcpConnectionPtr& conn) { onConnection(conn); });
+        server_.setMessageCallback(
+            [this](const muduo::net::TcpConnectionPtr& conn, muduo::net::Buffer* buf, muduo::Timestamp receiveTime) {
+                onMessage(conn, buf, receiveTime);
+            });
+        server_.setWriteCompleteCallback(
+            [this](const muduo::net::TcpConnectionPtr& conn) { onWriteComplete(conn); });
+    }
+
+    void HttpServer::start()
+    {
+        LOG_WARN << "HttpServer[" << server_.name() << "] starts listening on " << server_.ipPort();
+        // 启动前编译路由表与中间件链，之后修改路由需再次调用router().compile()才会生效，中间件需在启动前注册
+        router_.compile();
+        middlewareChain_.compile();
+        server_.start();
+        mainLoop_.loop();
+    }
+
+    void HttpServer::onConnection(const muduo::net::TcpConnectionPtr& conn)
+    {
+        if (conn->connected())
+        {
+            // 每个连接持有一个解析上下文，跨多次onMessage保存解析进度
+            ConnectionState state(maxBodySize_);
+            state.context.request().setPeerAddress(conn->peerAddress().toIp());
+            // 请求头到达后查找流式路由，命中则请求体不再缓存，直接交给处理器
+            state.context.setHeadersCallback([this](HttpContext* ctx) {
+                if (const Router::StreamingHandler* handler = router_.findStreamingHandler(ctx->request()))
+                {
+                    ctx->setBodySink(handler->onData, handler->maxBodySize, handler->onPause);
+                }
+            });
+            conn->setContext(state);
+        }
+    }
+
+    // 一次读到的数据中可能包含多个流水线(pipelining)请求：依次解析并按顺序处理，
+    // 所有响应先序列化进同一个缓冲区，最后只调用一次send
+    void HttpServer::onMessage(const muduo::net::TcpConnectionPtr& conn,
+                               muduo::net::Buffer* buf,
+                               muduo::Timestamp receiveTime)
+    {
+        auto* state = boost::any_cast<ConnectionState>(conn->getMutableContext());
+        if (state->transfer.file)
+        {
+            return; // 文件发送完成前不处理后续请求，数据留在输入缓冲区
+        }
+        HttpContext* context = &state->context;
+        // onMessage总在连接所属的IO线程中执行，同一线程的输出缓冲区可以复用
+        thread_local muduo::net::Buffer output;
+
+        bool close = false;
+        while (!close)
+        {
+            bool ok = false;
+            try
+            {
+                ok = context->parseRequest(buf, receiveTime);
+            }
+            catch (const std::exception& e)
+            {
+                // 流式处理器在接收请求体时抛出异常，请求无法继续
+                LOG_ERROR << "Exception while streaming request body: " << e.what();
+                output.append("HTTP/1.1 500 Internal Server Error\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+                buf->retrieveAll();
+                close = true;
+                break;
+            }
+            if (!ok)
+            {
+                output.append("HTTP/1.1 400 Bad Request\r\nConnection: close\r\nContent-Length: 0\r\n\r\n");
+                buf->retrieveAll();
+                close = true;
+                break;
+            }
+            if (!context->parseComplete())
+            {
+                break; // 剩余数据不足一个完整请求，等待下一次onMessage
+            }
+            close = onRequest(conn, context->request(), &output, &state->transfer);
+            context->reset();
+            if (state->transfer.file)
+            {
+                break; // 文件响应之后的流水线请求等文件发送完成再处理
+            }
+        }
+
+        if (output.readableBytes() > 0)
+        {
+            conn->send(&output);
+        }
+        if (state->transfer.file)
+        {
+            // 文件按分片发送，每个分片写完后由onWriteComplete发送下一片，期间暂停读取
+            state->transfer.close = close;
+            if (conn->isReading())
+            {
+                conn->stopRead();
+            }
+            sendFileSlice(conn, &state->transfer);
+            return;
+        }
+        if (close)
+        {
+            conn->shutdown();
+            return;
+        }
+
+        // 背压：流式处理器暂时无法消费更多请求体时停止读取，数据留在内核接收缓冲区，
+        // 由TCP流量控制让客户端放慢发送；处理器调用resume后再把输入缓冲区中剩余的数据交给它
+        if (context->bodyPaused())
+        {
+            if (conn->isReading())
+            {
+                conn->stopRead();
+            }
+            if (!context->pauseCallback())
+            {
+                LOG_ERROR << "Streaming handler for " << std::string(context->request().path())
+                          << " paused without onPause, closing " << conn->name();
+                conn->forceClose();
+                return;
+            }
+            std::weak_ptr<muduo::net::TcpConnection> weakConn(conn);
+            muduo::net::EventLoop* loop = conn->getLoop();
+            context->pauseCallback()(context->request(), [this, weakConn, loop] {
+                // 总是排队到连接所属线程执行，即使在onPause中同步调用也不会重入onMessage
+                loop->queueInLoop([this, weakConn] {
+                    if (muduo::net::TcpConnectionPtr c = weakConn.lock(); c && c->connected())
+                    {
+                        onMessage(c, c->inputBuffer(), muduo::Timestamp::now());
+                    }
+                });
+            });
+        }
+        else if (!conn->isReading())
+        {
+            conn->startRead();
+        }
+    }
+
+    void HttpServer::onWriteComplete(const muduo::net::TcpConnectionPtr& conn)
+    {
+        auto* state = boost::any_cast<ConnectionState>(conn->getMutableContext());
+        FileTransfer& transfer = state->transfer;
+        // 发送缓冲区仍有数据时等下一次写完成回调，保证同时只有一个分片在内存中
+        if (!transfer.file || conn->outputBuffer()->readableBytes() > 0)
+        {
+            return;
+        }
+        if (transfer.remaining > 0)
+        {
+            sendFileSlice(conn, &transfer);
+            return;
+        }
+
+        const bool close = transfer.close;
+        transfer = FileTransfer();
+        if (close)
+        {
+            conn->shutdown();
+            return;
+        }
+        // 继续处理文件发送期间已到达的流水线请求
+        conn->startRead();
+        if (conn->inputBuffer()->readableBytes() > 0)
+        {
+            onMessage(conn, conn->inputBuffer(), muduo::Timestamp::now());
+        }
+    }
+
+    void HttpServer::sendFileSlice(const muduo::net::TcpConnectionPtr& conn, FileTransfer* transfer)
+    {
+        thread_local std::vector<char> slice(kFileSliceSize);
+        const size_t n = static_cast<size_t>(std::min<uint64_t>(transfer->remaining, kFileSliceSize));
+        const ssize_t nread = ::pread(transfer->file->fd(), slice.data(), n, static_cast<off_t>(transfer->offset));
+        if (nread <= 0)
+        {
+            // 文件在发送过程中被截断或读取出错，已发出的Content-Length无法兑现，只能关闭连接
+            LOG_ERROR << "Failed to read " << transfer->file->path() << " at offset " << transfer->offset;
+            *transfer = FileTransfer();
+            conn->forceClose();
+            return;
+        }
+        transfer->offset += static_cast<uint64_t>(nread);
+        transfer->remaining -= static_cast<uint64_t>(nread);
+        conn->send(slice.data(), static_cast<int>(nread));
+    }
+
+    bool HttpServer::onRequest(const muduo::net::TcpConnectionPtr& conn,
+                               HttpRequest& req,
+                               muduo::net::Buffer* output,
+                               FileTransfer* transfer)
+    {
+        // HTTP/1.1默认长连接，HTTP/1.0需要显式声明Keep-Alive
+        const std::string_view connection = req.getHeader(HeaderId::kConnection);
+        const bool close = HttpHeaders::equalsIgnoreCase(connection, "close") ||
+            (req.getVersion() == "HTTP/1.0" && !HttpHeaders::equalsIgnoreCase(connection, "keep-alive"));
+
+        HttpResponse response(close);
+        response.setVersion(std::string(req.getVersion()));
+        handleRequest(req, &response);
+
+        if (response.isFile() && response.fileLength() > 0)
+        {
+            // 文件内容不经过输出缓冲区，由onMessage在头部发出后开始分片发送
+            response.appendHeadToBuffer(output);
+            transfer->file = response.file();
+            transfer->offset = response.fileOffset();
+            transfer->remaining = response.fileLength();
+            return response.closeConnection();
+        }
+
+        // 流水线中的后续响应依赖Content-Length定界，204与304响应不带响应体，预序列化的头部块与缓存的响应自带Content-Length
+        const HttpResponse::HttpStatusCode status = response.getStatusCode();
+        if (!response.headers().has(HeaderId::kContentLength) && !response.hasRawHeaders() && !response.isSerialized() &&
+            status != HttpResponse::k204NoContent && status != HttpResponse::k304NotModified)
+        {
+            response.setContentLength(response.body().size());
+        }
+
+        const std::string_view body = response.body();
+        if (body.size() >= kGatherBodySize)
+        {
+            // 大响应体不拷贝进输出缓冲区：先发出之前累积的响应和本响应的头部，再单独发送响应体
+            // 连接的发送缓冲区为空时muduo直接write到socket，只有内核缓冲区写满时剩余部分才会被拷贝
+            response.appendHeadToBuffer(output);
+            conn->send(output);
+            conn->send(body.data(), static_cast<int>(body.size()));
+        }
+        else
+        {
+            response.appendToBuffer(output);
+        }
+        return response.closeConnection();
+    }
+
+    void HttpServer::handleRequest(HttpRequest& req, HttpResponse* resp)
+    {
+        try
+        {
+            // 中间件可以直接生成响应而跳过路由，after()只对放行了请求的中间件调用
+            const MiddlewareChain::Pipeline& pipeline = middlewareChain_.select(req);
+            size_t passed = 0;
+            if (MiddlewareChain::handleRequest(pipeline, req, *resp, &passed) && !router_.route(req, resp))
+            {
+                resp->setStatusLine(resp->version(), HttpResponse::k404NotFound, "Not Found");
+            }
+            MiddlewareChain::handleResponse(pipeline, passed, req, *resp);
+        }
+        catch (const std::exception& e)
+        {
+            LOG_ERROR << "Exception while handling " << std::string(req.path()) << ": " << e.what();
+            resp->setStatusLine(resp->version(), HttpResponse::k500InternalServerError, "Internal Server Error");
+            resp->setBody("");
+            resp->setCloseConnection(true);
+        }
+    }
+}
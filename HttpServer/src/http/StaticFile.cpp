@@ -0,0 +1,288 @@
+#include "http/StaticFile.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace tinyHttp
+{
+    namespace
+    {
+        enum class RangeResult
+        {
+            kNone,          // 没有Range头部或格式无法识别，返回整个文件
+            kSatisfiable,   // 合法的单个范围
+            kUnsatisfiable, // 范围超出文件长度
+        };
+
+        std::string_view trim(std::string_view s)
+        {
+            while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+            {
+                s.remove_prefix(1);
+            }
+            while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+            {
+                s.remove_suffix(1);
+            }
+            return s;
+        }
+
+        bool parseNumber(std::string_view s, uint64_t& value)
+        {
+            const auto result = std::from_chars(s.data(), s.data() + s.size(), value);
+            return !s.empty() && result.ec == std::errc() && result.ptr == s.data() + s.size();
+        }
+
+        // 只支持单个范围："bytes=0-499"、"bytes=500-"、"bytes=-500"，多个范围按整个文件返回
+        RangeResult parseRange(std::string_view range, uint64_t size, uint64_t& offset, uint64_t& length)
+        {
+            constexpr std::string_view kPrefix = "bytes=";
+            if (range.substr(0, kPrefix.size()) != kPrefix)
+            {
+                return RangeResult::kNone;
+            }
+            range = trim(range.substr(kPrefix.size()));
+            const size_t dash = range.find('-');
+            if (dash == std::string_view::npos || range.find(',') != std::string_view::npos)
+            {
+                return RangeResult::kNone;
+            }
+            const std::string_view first = trim(range.substr(0, dash));
+            const std::string_view last = trim(range.substr(dash + 1));
+
+            uint64_t start = 0;
+            uint64_t end = 0;
+            if (first.empty())
+            {
+                // 后缀范围：最后N个字节
+                uint64_t suffix = 0;
+                if (!parseNumber(last, suffix))
+                {
+                    return RangeResult::kNone;
+                }
+                if (suffix == 0 || size == 0)
+                {
+                    return RangeResult::kUnsatisfiable;
+                }
+                start = suffix >= size ? 0 : size - suffix;
+                end = size - 1;
+            }
+            else
+            {
+                if (!parseNumber(first, start))
+                {
+                    return RangeResult::kNone;
+                }
+                if (last.empty())
+                {
+                    end = size - 1;
+                }
+                else if (!parseNumber(last, end) || end < start)
+                {
+                    return RangeResult::kNone;
+                }
+                if (start >= size)
+                {
+                    return RangeResult::kUnsatisfiable;
+                }
+                end = std::min(end, size - 1);
+            }
+            offset = start;
+            length = end - start + 1;
+            return RangeResult::kSatisfiable;
+        }
+
+        bool parseHttpDate(std::string_view date, time_t& t)
+        {
+            const std::string s(date);
+            struct tm tm = {};
+            const char* end = strptime(s.c_str(), "%a, %d %b %Y %H:%M:%S GMT", &tm);
+            if (!end || *end != '\0')
+            {
+                return false;
+            }
+            t = timegm(&tm);
+            return true;
+        }
+
+        std::string toString(uint64_t value)
+        {
+            char buf[24];
+            return std::string(buf, std::to_chars(buf, buf + sizeof buf, value).ptr);
+        }
+    }
+
+    StaticFile::StaticFile(int fd, std::string path, uint64_t size, time_t mtime)
+        : fd_(fd)
+        , path_(std::move(path))
+        , size_(size)
+        , mtime_(mtime)
+        , etag_(makeETag(size, mtime))
+        , lastModified_(httpDate(mtime))
+    {
+
+    }
+
+    StaticFile::~StaticFile()
+    {
+        ::close(fd_);
+    }
+
+    std::shared_ptr<StaticFile> StaticFile::open(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            ::close(fd);
+            return nullptr;
+        }
+        return std::shared_ptr<StaticFile>(
+            new StaticFile(fd, path, static_cast<uint64_t>(st.st_size), st.st_mtime));
+    }
+
+    bool StaticFile::serve(const HttpRequest& req, const std::string& path, HttpResponse* resp)
+    {
+        std::shared_ptr<StaticFile> file = open(path);
+        if (!file)
+        {
+            resp->setStatusLine(resp->version(), HttpResponse::k404NotFound, "Not Found");
+            return false;
+        }
+        respond(req, file, resp);
+        return true;
+    }
+
+    void StaticFile::respond(const HttpRequest& req, const std::shared_ptr<StaticFile>& file, HttpResponse* resp)
+    {
+        resp->addHeader("ETag", file->etag());
+        resp->addHeader("Last-Modified", file->lastModified());
+        resp->addHeader("Accept-Ranges", "bytes");
+
+        if (notModified(req, file->etag(), file->mtime()))
+        {
+            resp->setStatusLine(resp->version(), HttpResponse::k304NotModified, "Not Modified");
+            return;
+        }
+
+        uint64_t offset = 0;
+        uint64_t length = file->size();
+        RangeResult range = RangeResult::kNone;
+        const std::string_view rangeHeader = req.getHeader(HeaderId::kRange);
+        // If-Range与当前ETag不一致时忽略Range，返回整个文件
+        const std::string_view ifRange = req.getHeader("If-Range");
+        if (!rangeHeader.empty() && (ifRange.empty() || ifRange == file->etag()))
+        {
+            range = parseRange(rangeHeader, file->size(), offset, length);
+        }
+
+        if (range == RangeResult::kUnsatisfiable)
+        {
+            resp->setStatusLine(resp->version(), HttpResponse::k416RangeNotSatisfiable, "Range Not Satisfiable");
+            resp->addHeader("Content-Range", "bytes */" + toString(file->size()));
+            resp->setContentLength(0);
+            return;
+        }
+        if (range == RangeResult::kSatisfiable)
+        {
+            resp->setStatusLine(resp->version(), HttpResponse::k206PartialContent, "Partial Content");
+            resp->addHeader("Content-Range", "bytes " + toString(offset) + "-" + toString(offset + length - 1) +
+                                             "/" + toString(file->size()));
+        }
+        else
+        {
+            resp->setStatusLine(resp->version(), HttpResponse::k200Ok, "OK");
+        }
+        resp->setContentType(contentType(file->path()));
+        resp->setContentLength(length);
+        if (req.method() != HttpRequest::kHead)
+        {
+            resp->setFile(file, offset, length);
+        }
+    }
+
+    std::string StaticFile::makeETag(uint64_t size, time_t mtime)
+    {
+        char buf[48];
+        char* p = buf;
+        *p++ = '"';
+        p = std::to_chars(p, buf + sizeof buf, size, 16).ptr;
+        *p++ = '-';
+        p = std::to_chars(p, buf + sizeof buf, static_cast<uint64_t>(mtime), 16).ptr;
+        *p++ = '"';
+        return std::string(buf, p);
+    }
+
+    std::string StaticFile::httpDate(time_t t)
+    {
+        struct tm tm;
+        gmtime_r(&t, &tm);
+        char buf[32];
+        const size_t n = strftime(buf, sizeof buf, "%a, %d %b %Y %H:%M:%S GMT", &tm);
+        return std::string(buf, n);
+    }
+
+    bool StaticFile::notModified(const HttpRequest& req, std::string_view etag, time_t mtime)
+    {
+        // If-None-Match优先于If-Modified-Since，按弱比较匹配
+        const std::string_view ifNoneMatch = req.getHeader(HeaderId::kIfNoneMatch);
+        if (!ifNoneMatch.empty())
+        {
+            std::string_view rest = ifNoneMatch;
+            while (!rest.empty())
+            {
+                const size_t comma = rest.find(',');
+                std::string_view tag = trim(rest.substr(0, comma));
+                rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+                if (tag.substr(0, 2) == "W/")
+                {
+                    tag.remove_prefix(2);
+                }
+                if (tag == "*" || tag == etag)
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const std::string_view ifModifiedSince = req.getHeader(HeaderId::kIfModifiedSince);
+        time_t since = 0;
+        return !ifModifiedSince.empty() && parseHttpDate(ifModifiedSince, since) && mtime <= since;
+    }
+
+    std::string_view StaticFile::contentType(std::string_view path)
+    {
+        const size_t dot = path.rfind('.');
+        if (dot == std::string_view::npos || path.find('/', dot) != std::string_view::npos)
+        {
+            return "application/octet-stream";
+        }
+        const std::string_view ext = path.substr(dot + 1);
+        if (HttpHeaders::equalsIgnoreCase(ext, "html") || HttpHeaders::equalsIgnoreCase(ext, "htm"))
+            return "text/html; charset=utf-8";
+        if (HttpHeaders::equalsIgnoreCase(ext, "css"))  return "text/css; charset=utf-8";
+        if (HttpHeaders::equalsIgnoreCase(ext, "js"))   return "application/javascript; charset=utf-8";
+        if (HttpHeaders::equalsIgnoreCase(ext, "json")) return "application/json";
+        if (HttpHeaders::equalsIgnoreCase(ext, "txt"))  return "text/plain; charset=utf-8";
+        if (HttpHeaders::equalsIgnoreCase(ext, "svg"))  return "image/svg+xml";
+        if (HttpHeaders::equalsIgnoreCase(ext, "png"))  return "image/png";
+        if (HttpHeaders::equalsIgnoreCase(ext, "jpg") || HttpHeaders::equalsIgnoreCase(ext, "jpeg"))
+            return "image/jpeg";
+        if (HttpHeaders::equalsIgnoreCase(ext, "gif"))  return "image/gif";
+        if (HttpHeaders::equalsIgnoreCase(ext, "ico"))  return "image/x-icon";
+        if (HttpHeaders::equalsIgnoreCase(ext, "webp")) return "image/webp";
+        if (HttpHeaders::equalsIgnoreCase(ext, "woff2")) return "font/woff2";
+        if (HttpHeaders::equalsIgnoreCase(ext, "wasm")) return "application/wasm";
+        if (HttpHeaders::equalsIgnoreCase(ext, "pdf"))  return "application/pdf";
+        if (HttpHeaders::equalsIgnoreCase(ext, "mp4"))  return "video/mp4";
+        return "application/octet-stream";
+    }
+}
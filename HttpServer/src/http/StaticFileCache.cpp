@@ -0,0 +1,312 @@
+#include "http/StaticFileCache.h"
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <muduo/base/Logging.h>
+#include "http/StaticFile.h"
+
+namespace tinyHttp
+{
+    namespace
+    {
+        // 小于该长度的文件压缩收益不明显，不生成压缩版本
+        constexpr size_t kMinCompressSize = 256;
+
+        bool isCompressible(std::string_view contentType)
+        {
+            return contentType.substr(0, 5) == "text/" ||
+                   contentType.find("javascript") != std::string_view::npos ||
+                   contentType.find("json") != std::string_view::npos ||
+                   contentType.find("xml") != std::string_view::npos ||
+                   contentType == "application/wasm";
+        }
+
+        // 一次性压缩整个文件，windowBits为15+16时生成gzip格式，为15时生成zlib格式（HTTP的deflate编码）
+        bool compress(const char* data, size_t len, int windowBits, std::string* out)
+        {
+            z_stream zs = {};
+            if (deflateInit2(&zs, Z_BEST_COMPRESSION, Z_DEFLATED, windowBits, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                return false;
+            }
+            out->resize(deflateBound(&zs, len));
+            zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+            zs.avail_in = static_cast<uInt>(len);
+            zs.next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+            zs.avail_out = static_cast<uInt>(out->size());
+            const int ret = deflate(&zs, Z_FINISH);
+            out->resize(zs.total_out);
+            deflateEnd(&zs);
+            return ret == Z_STREAM_END;
+        }
+    }
+
+    bool StaticFileCache::serve(const HttpRequest& req, const std::string& path, HttpResponse* resp)
+    {
+        // 范围请求不常见，直接按文件分片处理
+        if (req.headers().has(HeaderId::kRange))
+        {
+            return StaticFile::serve(req, path, resp);
+        }
+
+        EntryPtr entry = lookup(path);
+        if (!entry)
+        {
+            bool bypass = false;
+            std::shared_ptr<Entry> loaded = load(path, &bypass);
+            if (!loaded)
+            {
+                if (bypass)
+                {
+                    return StaticFile::serve(req, path, resp);
+                }
+                resp->setStatusLine(resp->version(), HttpResponse::k404NotFound, "Not Found");
+                return false;
+            }
+            entry = loaded;
+            insert(entry);
+        }
+
+        const Variant& variant = entry->variants[chooseEncoding(req, *entry)];
+        if (StaticFile::notModified(req, variant.etag, entry->mtime))
+        {
+            resp->setStatusLine(resp->version(), HttpResponse::k304NotModified, "Not Modified");
+            resp->setRawHeaders(variant.notModifiedHeaders);
+            return true;
+        }
+
+        resp->setStatusLine(resp->version(), HttpResponse::k200Ok, "OK");
+        resp->setRawHeaders(variant.headers);
+        if (req.method() != HttpRequest::kHead)
+        {
+            resp->setBody(variant.data, variant.length);
+        }
+        return true;
+    }
+
+    std::shared_ptr<StaticFileCache::Entry> StaticFileCache::load(const std::string& path, bool* bypass) const
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+        {
+            return nullptr;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode))
+        {
+            ::close(fd);
+            return nullptr;
+        }
+        const size_t size = static_cast<size_t>(st.st_size);
+        if (size > maxEntrySize_)
+        {
+            ::close(fd);
+            *bypass = true;
+            return nullptr;
+        }
+
+        auto entry = std::make_shared<Entry>();
+        entry->path = path;
+        entry->size = size;
+        entry->mtime = st.st_mtime;
+
+        // 文件内容读入内存而不是映射：缓存期间文件被截断时，访问映射中超出文件末尾的页会触发SIGBUS，
+        // 读入的副本则不受影响，文件的变化在下一次重新检查时发现。缓存项不超过maxEntrySize_，拷贝的代价有限
+        Variant& identity = entry->variants[kIdentity];
+        if (size > 0)
+        {
+            auto content = std::make_shared<std::string>(size, '\0');
+            size_t total = 0;
+            while (total < size)
+            {
+                const ssize_t n = ::pread(fd, &(*content)[total], size - total, static_cast<off_t>(total));
+                if (n <= 0)
+                {
+                    break;
+                }
+                total += static_cast<size_t>(n);
+            }
+            if (total != size)
+            {
+                // 读取过程中文件被截断或读取出错，本次不缓存，交给StaticFile按当前文件处理
+                LOG_WARN << "Failed to read " << path << " for caching, " << total << " of " << size << " bytes";
+                ::close(fd);
+                *bypass = true;
+                return nullptr;
+            }
+            identity.data = std::shared_ptr<const char>(content, content->data());
+            identity.length = size;
+        }
+        ::close(fd);
+
+        const std::string_view contentType = StaticFile::contentType(path);
+        if (size >= kMinCompressSize && isCompressible(contentType))
+        {
+            const int windowBits[kNumEncodings] = {0, 15 + 16, 15};
+            for (int enc = kGzip; enc < kNumEncodings; ++enc)
+            {
+                auto compressed = std::make_shared<std::string>();
+                // 只保留确实更小的压缩结果
+                if (compress(identity.data.get(), size, windowBits[enc], compressed.get()) && compressed->size() < size)
+                {
+                    Variant& variant = entry->variants[enc];
+                    variant.length = compressed->size();
+                    variant.data = std::shared_ptr<const char>(compressed, compressed->data());
+                }
+            }
+        }
+
+        // 预先序列化每个版本的头部，压缩版本的ETag带上编码名以区分不同的表示
+        const bool vary = entry->variants[kGzip].data || entry->variants[kDeflate].data;
+        const std::string etag = StaticFile::makeETag(size, st.st_mtime);
+        const std::string lastModified = "Last-Modified: " + StaticFile::httpDate(st.st_mtime) + "\r\n" +
+                                         (vary ? "Vary: Accept-Encoding\r\n" : "");
+        const char* const encodingNames[kNumEncodings] = {nullptr, "gzip", "deflate"};
+        entry->bytes = size;
+        for (int enc = kIdentity; enc < kNumEncodings; ++enc)
+        {
+            Variant& variant = entry->variants[enc];
+            if (enc != kIdentity && !variant.data)
+            {
+                continue;
+            }
+            variant.etag = enc == kIdentity ? etag
+                                            : etag.substr(0, etag.size() - 1) + "-" + encodingNames[enc] + "\"";
+            const std::string validators = "ETag: " + variant.etag + "\r\n" + lastModified;
+            variant.notModifiedHeaders = std::make_shared<const std::string>(validators);
+
+            std::string headers;
+            headers.append("Content-Type: ").append(contentType).append("\r\n");
+            headers.append("Content-Length: ").append(std::to_string(variant.length)).append("\r\n");
+            if (enc != kIdentity)
+            {
+                headers.append("Content-Encoding: ").append(encodingNames[enc]).append("\r\n");
+                entry->bytes += variant.length;
+            }
+            headers.append(validators);
+            entry->bytes += headers.size() + validators.size();
+            variant.headers = std::make_shared<const std::string>(std::move(headers));
+        }
+        return entry;
+    }
+
+    StaticFileCache::EntryPtr StaticFileCache::lookup(const std::string& path)
+    {
+        const muduo::Timestamp now = muduo::Timestamp::now();
+        EntryPtr entry;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            auto it = index_.find(path);
+            if (it == index_.end())
+            {
+                return nullptr;
+            }
+            lru_.splice(lru_.begin(), lru_, it->second);
+            if (muduo::timeDifference(now, it->second->checkedAt) < revalidateInterval_)
+            {
+                return it->second->entry;
+            }
+            entry = it->second->entry;
+        }
+
+        // 在锁外检查文件是否被修改，避免阻塞其他线程的命中
+        struct stat st;
+        const bool unchanged = ::stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) &&
+                               static_cast<uint64_t>(st.st_size) == entry->size && st.st_mtime == entry->mtime;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(path);
+        if (it != index_.end() && it->second->entry == entry)
+        {
+            if (unchanged)
+            {
+                it->second->checkedAt = now;
+            }
+            else
+            {
+                removeLocked(it);
+            }
+        }
+        return unchanged ? entry : nullptr;
+    }
+
+    void StaticFileCache::insert(EntryPtr entry)
+    {
+        if (entry->bytes > maxBytes_)
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(entry->path);
+        if (it != index_.end())
+        {
+            removeLocked(it);
+        }
+        bytes_ += entry->bytes;
+        const std::string& path = entry->path;
+        lru_.push_front(Node{std::move(entry), muduo::Timestamp::now()});
+        index_.emplace(path, lru_.begin());
+        evict();
+    }
+
+    void StaticFileCache::removeLocked(std::unordered_map<std::string, std::list<Node>::iterator>::iterator it)
+    {
+        bytes_ -= it->second->entry->bytes;
+        lru_.erase(it->second);
+        index_.erase(it);
+    }
+
+    void StaticFileCache::evict()
+    {
+        while (bytes_ > maxBytes_ && !lru_.empty())
+        {
+            removeLocked(index_.find(lru_.back().entry->path));
+        }
+    }
+
+    void StaticFileCache::invalidate(const std::string& path)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(path);
+        if (it != index_.end())
+        {
+            removeLocked(it);
+        }
+    }
+
+    void StaticFileCache::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_.clear();
+        lru_.clear();
+        bytes_ = 0;
+    }
+
+    size_t StaticFileCache::size() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return lru_.size();
+    }
+
+    size_t StaticFileCache::bytes() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return bytes_;
+    }
+
+    StaticFileCache::Encoding StaticFileCache::chooseEncoding(const HttpRequest& req, const Entry& entry)
+    {
+        if (entry.variants[kGzip].data && req.acceptsEncoding("gzip"))
+        {
+            return kGzip;
+        }
+        if (entry.variants[kDeflate].data && req.acceptsEncoding("deflate"))
+        {
+            return kDeflate;
+        }
+        return kIdentity;
+    }
+}
@@ -0,0 +1,190 @@
+#include "middleware/CompressionMiddleware.h"
+
+#include <zlib.h>
+
+#include <muduo/base/Logging.h>
+
+namespace tinyHttp
+{
+    namespace
+    {
+        // 线程内复用的压缩器，z_stream只在第一次使用时初始化，线程退出时释放
+        class Deflater
+        {
+        public:
+            explicit Deflater(int windowBits)
+            : windowBits_(windowBits)
+            , level_(-1)
+            , initialized_(false)
+            {
+                stream_ = z_stream();
+            }
+
+            ~Deflater()
+            {
+                if (initialized_)
+                {
+                    deflateEnd(&stream_);
+                }
+            }
+
+            Deflater(const Deflater&) = delete;
+            Deflater& operator=(const Deflater&) = delete;
+
+            // 压缩整个输入，结果写入out，失败返回false
+            bool compress(std::string_view input, int level, std::string* out)
+            {
+                if (!initialized_)
+                {
+                    if (deflateInit2(&stream_, level, Z_DEFLATED, windowBits_, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+                    {
+                        LOG_ERROR << "deflateInit2 failed";
+                        return false;
+                    }
+                    initialized_ = true;
+                    level_ = level;
+                }
+                else
+                {
+                    deflateReset(&stream_);
+                    if (level != level_ && deflateParams(&stream_, level, Z_DEFAULT_STRATEGY) == Z_OK)
+                    {
+                        level_ = level;
+                    }
+                }
+
+                // 按上界一次分配输出空间，单次deflate即可完成
+                out->resize(deflateBound(&stream_, input.size()));
+                stream_.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+                stream_.avail_in = static_cast<uInt>(input.size());
+                stream_.next_out = reinterpret_cast<Bytef*>(&(*out)[0]);
+                stream_.avail_out = static_cast<uInt>(out->size());
+                const int ret = deflate(&stream_, Z_FINISH);
+                out->resize(stream_.total_out);
+                return ret == Z_STREAM_END;
+            }
+
+        private:
+            z_stream  stream_;
+            const int windowBits_;
+            int       level_;
+            bool      initialized_;
+        };
+
+        Deflater& gzipDeflater()
+        {
+            thread_local Deflater deflater(15 + 16);
+            return deflater;
+        }
+
+        Deflater& zlibDeflater()
+        {
+            thread_local Deflater deflater(15);
+            return deflater;
+        }
+
+        // 在Vary中追加Accept-Encoding，保留处理器已设置的其他字段（如Origin），已包含或为"*"时不变
+        void addVaryAcceptEncoding(HttpResponse& response)
+        {
+            const std::string_view vary = response.getHeader("Vary");
+            std::string_view rest = vary;
+            while (!rest.empty())
+            {
+                const size_t comma = rest.find(',');
+                std::string_view token = rest.substr(0, comma);
+                rest = comma == std::string_view::npos ? std::string_view() : rest.substr(comma + 1);
+                while (!token.empty() && (token.front() == ' ' || token.front() == '\t'))
+                {
+                    token.remove_prefix(1);
+                }
+                while (!token.empty() && (token.back() == ' ' || token.back() == '\t'))
+                {
+                    token.remove_suffix(1);
+                }
+                if (token == "*" || HttpHeaders::equalsIgnoreCase(token, "Accept-Encoding"))
+                {
+                    return;
+                }
+            }
+            response.addHeader("Vary", vary.empty() ? std::string("Accept-Encoding")
+                                                    : std::string(vary) + ", Accept-Encoding");
+        }
+    }
+
+    CompressionMiddleware::CompressionMiddleware(size_t minSize, int level)
+        : minSize_(minSize)
+        , level_(level)
+        , contentTypes_{"text/", "application/json", "application/javascript", "application/xml", "image/svg+xml"}
+    {
+
+    }
+
+    bool CompressionMiddleware::before(HttpRequest&, HttpResponse&)
+    {
+        return true;
+    }
+
+    void CompressionMiddleware::after(const HttpRequest& request, HttpResponse& response)
+    {
+        // 文件响应与预序列化头部的缓存响应各自处理编码
+        if (response.isFile() || response.hasRawHeaders() || response.isSerialized() ||
+            response.headers().has(HeaderId::kContentEncoding))
+        {
+            return;
+        }
+        const std::string_view body = response.body();
+        if (body.size() < minSize_ || !compressible(response.getHeader(HeaderId::kContentType)))
+        {
+            return;
+        }
+        // 可压缩的响应是否压缩取决于Accept-Encoding，未压缩时同样需要告知下游缓存
+        addVaryAcceptEncoding(response);
+
+        Encoding encoding = kNone;
+        if (request.acceptsEncoding("gzip"))
+        {
+            encoding = kGzip;
+        }
+        else if (request.acceptsEncoding("deflate"))
+        {
+            encoding = kDeflate;
+        }
+        if (encoding == kNone)
+        {
+            return;
+        }
+
+        std::string compressed;
+        Deflater& deflater = encoding == kGzip ? gzipDeflater() : zlibDeflater();
+        if (!deflater.compress(body, level_, &compressed) || compressed.size() >= body.size())
+        {
+            return;
+        }
+
+        response.setBody(std::move(compressed));
+        response.addHeader("Content-Encoding", encoding == kGzip ? "gzip" : "deflate");
+        if (response.headers().has(HeaderId::kContentLength))
+        {
+            response.setContentLength(response.body().size());
+        }
+        // 内容编码改变了表示，强校验ETag不再适用
+        const std::string_view etag = response.getHeader("ETag");
+        if (!etag.empty() && etag.substr(0, 2) != "W/")
+        {
+            response.addHeader("ETag", "W/" + std::string(etag));
+        }
+    }
+
+    bool CompressionMiddleware::compressible(std::string_view contentType) const
+    {
+        for (const auto& prefix : contentTypes_)
+        {
+            // 媒体类型不区分大小写
+            if (HttpHeaders::equalsIgnoreCase(contentType.substr(0, prefix.size()), prefix))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+}
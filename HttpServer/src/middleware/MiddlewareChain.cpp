@@ -0,0 +1,132 @@
+#include "middleware/MiddlewareChain.h"
+
+#include <algorithm>
+
+#include <muduo/base/Logging.h>
+
+namespace tinyHttp
+{
+    std::string MiddlewareChain::normalizePrefix(const std::string& prefix)
+    {
+        std::string normalized = prefix.empty() || prefix.front() != '/' ? "/" + prefix : prefix;
+        while (!normalized.empty() && normalized.back() == '/')
+        {
+            normalized.pop_back();
+        }
+        return normalized; // 空串表示根路径，匹配所有请求
+    }
+
+    bool MiddlewareChain::registerRouteMiddleware(HttpRequest::Method method, const std::string& path,
+                                                  std::shared_ptr<Middleware> middleware)
+    {
+        // 与RouteTrie一致，以':'或'*'开头的路径段是动态段
+        for (size_t i = 0; i < path.size(); ++i)
+        {
+            if ((path[i] == ':' || path[i] == '*') && (i == 0 || path[i - 1] == '/'))
+            {
+                LOG_ERROR << "Route middleware requires a static path: " << path;
+                return false;
+            }
+        }
+        add(kRoute, method, path, std::move(middleware));
+        return true;
+    }
+
+    MiddlewareChain::Pipeline MiddlewareChain::collect(HttpRequest::Method method, std::string_view path, bool exact) const
+    {
+        Pipeline pipeline;
+        for (const Binding& binding : bindings_)
+        {
+            bool matched = false;
+            switch (binding.scope)
+            {
+            case kGlobal:
+                matched = true;
+                break;
+            case kPrefix:
+                matched = prefixMatches(binding.path, path);
+                break;
+            case kRoute:
+                matched = exact && binding.method == method && binding.path == path;
+                break;
+            }
+            if (matched)
+            {
+                pipeline.push_back(binding.middleware.get());
+            }
+        }
+        return pipeline;
+    }
+
+    void MiddlewareChain::compile()
+    {
+        global_ = collect(HttpRequest::kInvalid, std::string_view(), false);
+
+        // 每个前缀的数组包含全局中间件与所有匹配该前缀的前缀中间件，按注册顺序排列
+        prefixes_.clear();
+        for (const Binding& binding : bindings_)
+        {
+            if (binding.scope != kPrefix)
+            {
+                continue;
+            }
+            auto it = std::find_if(prefixes_.begin(), prefixes_.end(),
+                                   [&](const auto& item) { return item.first == binding.path; });
+            if (it == prefixes_.end())
+            {
+                prefixes_.emplace_back(binding.path, collect(HttpRequest::kInvalid, binding.path, false));
+            }
+        }
+        std::stable_sort(prefixes_.begin(), prefixes_.end(),
+                         [](const auto& a, const auto& b) { return a.first.size() > b.first.size(); });
+
+        routePipelines_.clear();
+        std::vector<PerfectHashMap<int>::Entry> entries;
+        for (const Binding& binding : bindings_)
+        {
+            if (binding.scope != kRoute)
+            {
+                continue;
+            }
+            auto it = std::find_if(entries.begin(), entries.end(), [&](const auto& entry) {
+                return entry.method == binding.method && entry.path == binding.path;
+            });
+            if (it == entries.end())
+            {
+                entries.push_back({binding.method, binding.path, static_cast<int>(routePipelines_.size())});
+                routePipelines_.push_back(collect(binding.method, binding.path, true));
+            }
+        }
+        routes_ = PerfectHashMap<int>(std::move(entries));
+        // release保证其他线程读到compiled_为true时能看到完整的中间件数组
+        compiled_.store(true, std::memory_order_release);
+    }
+
+    const MiddlewareChain::Pipeline& MiddlewareChain::select(const HttpRequest& request)
+    {
+        if (!compiled_.load(std::memory_order_acquire))
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!compiled_.load(std::memory_order_relaxed))
+            {
+                compile();
+            }
+        }
+        const std::string_view path = request.path();
+        if (!routes_.empty())
+        {
+            if (const int* index = routes_.find(request.method(), path))
+            {
+                return routePipelines_[*index];
+            }
+        }
+        for (const auto& prefix : prefixes_)
+        {
+            if (prefixMatches(prefix.first, path))
+            {
+                return prefix.second;
+            }
+        }
+        return global_;
+    }
+}
@@ -0,0 +1,191 @@
+#include "middleware/RateLimitMiddleware.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+namespace tinyHttp
+{
+    namespace
+    {
+        constexpr std::string_view kRejectedBody = "Too Many Requests\n";
+    }
+
+    RateLimitMiddleware::RateLimitMiddleware(double ratePerSecond, double burst, std::string keyHeader,
+                                             size_t maxBuckets)
+        : interval_(static_cast<int64_t>(1e9 / std::max(ratePerSecond, 1e-9)))
+        , burstWindow_(static_cast<int64_t>(1e9 / std::max(ratePerSecond, 1e-9) * std::max(burst, 1.0)))
+        , keyHeader_(std::move(keyHeader))
+        , maxShardBuckets_(std::max<size_t>(maxBuckets / kShards, 1))
+    {
+
+    }
+
+    int64_t RateLimitMiddleware::nowNanos()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    bool RateLimitMiddleware::makeRoom(Shard& shard, int64_t now)
+    {
+        if (shard.buckets.size() < maxShardBuckets_)
+        {
+            return true;
+        }
+        if (now < shard.nextIdle)
+        {
+            return false;
+        }
+        // tat不晚于now说明令牌已补满，删除后重新创建的桶状态相同
+        int64_t nextIdle = std::numeric_limits<int64_t>::max();
+        for (auto it = shard.buckets.begin(); it != shard.buckets.end();)
+        {
+            const int64_t tat = it->second->tat.load(std::memory_order_relaxed);
+            if (tat <= now)
+            {
+                it = shard.buckets.erase(it);
+            }
+            else
+            {
+                nextIdle = std::min(nextIdle, tat);
+                ++it;
+            }
+        }
+        shard.nextIdle = nextIdle;
+        return shard.buckets.size() < maxShardBuckets_;
+    }
+
+    RateLimitMiddleware::AcquireResult RateLimitMiddleware::acquire(std::string_view key, double* retryAfter)
+    {
+        Shard& shard = shardOf(key);
+        std::shared_lock<std::shared_mutex> readLock(shard.mutex);
+        auto it = shard.buckets.find(key);
+        // 新客户端：加写锁创建桶后重新持有读锁，确保取令牌期间桶不会被清理
+        while (it == shard.buckets.end())
+        {
+            readLock.unlock();
+            {
+                std::unique_lock<std::shared_mutex> writeLock(shard.mutex);
+                if (shard.buckets.find(key) == shard.buckets.end())
+                {
+                    const int64_t now = nowNanos();
+                    if (!makeRoom(shard, now))
+                    {
+                        if (retryAfter)
+                        {
+                            *retryAfter = static_cast<double>(shard.nextIdle - now) / 1e9;
+                        }
+                        return kFull;
+                    }
+                    auto bucket = std::make_unique<Bucket>(key);
+                    const std::string_view stored = bucket->key;
+                    shard.buckets.emplace(stored, std::move(bucket));
+                    // 新桶取过令牌后最早在一个补充间隔后补满
+                    shard.nextIdle = std::min(shard.nextIdle, now + interval_);
+                }
+            }
+            readLock.lock();
+            it = shard.buckets.find(key);
+        }
+
+        // GCRA：桶满时tat不晚于now，每取一个令牌tat后移一个补充间隔，超出burst窗口则拒绝
+        std::atomic<int64_t>& tat = it->second->tat;
+        const int64_t now = nowNanos();
+        int64_t current = tat.load(std::memory_order_relaxed);
+        while (true)
+        {
+            const int64_t next = std::max(current, now) + interval_;
+            if (next - now > burstWindow_)
+            {
+                if (retryAfter)
+                {
+                    *retryAfter = static_cast<double>(next - now - burstWindow_) / 1e9;
+                }
+                return kLimited;
+            }
+            if (tat.compare_exchange_weak(current, next, std::memory_order_relaxed))
+            {
+                return kAcquired;
+            }
+        }
+    }
+
+    bool RateLimitMiddleware::before(HttpRequest& request, HttpResponse& response)
+    {
+        std::string_view key;
+        if (!keyHeader_.empty())
+        {
+            key = request.getHeader(keyHeader_);
+        }
+        double retryAfter = 0;
+        AcquireResult acquired = acquire(key.empty() ? std::string_view(request.peerAddress()) : key, &retryAfter);
+        // 伪造大量不同的请求头值占满分段时，这些请求改为按IP限流
+        if (acquired == kFull && !key.empty())
+        {
+            acquired = acquire(request.peerAddress(), &retryAfter);
+        }
+        if (acquired == kAcquired)
+        {
+            return true;
+        }
+
+        response.setStatusCode(HttpResponse::k429TooManyRequests);
+        response.setContentType("text/plain");
+        char seconds[24];
+        const auto result = std::to_chars(seconds, seconds + sizeof seconds,
+                                          static_cast<uint64_t>(std::max(1.0, std::ceil(retryAfter))));
+        response.addHeader("Retry-After", std::string_view(seconds, result.ptr - seconds));
+        response.setBody(std::string(kRejectedBody));
+        return false;
+    }
+
+    size_t RateLimitMiddleware::evictIdle(double idleSeconds)
+    {
+        const int64_t deadline = nowNanos() - static_cast<int64_t>(idleSeconds * 1e9);
+        size_t evicted = 0;
+        for (Shard& shard : shards_)
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            for (auto it = shard.buckets.begin(); it != shard.buckets.end();)
+            {
+                // tat早于deadline说明令牌早已补满，删除后重新创建的桶状态相同
+                if (it->second->tat.load(std::memory_order_relaxed) < deadline)
+                {
+                    it = shard.buckets.erase(it);
+                    ++evicted;
+                }
+                else
+                {
+                    ++it;
+                }
+            }
+        }
+        return evicted;
+    }
+
+    void RateLimitMiddleware::startEviction(muduo::net::EventLoop* loop, double interval, double idleSeconds)
+    {
+        std::weak_ptr<RateLimitMiddleware> weak = shared_from_this();
+        loop->runEvery(interval, [weak, idleSeconds] {
+            if (auto limiter = weak.lock())
+            {
+                limiter->evictIdle(idleSeconds);
+            }
+        });
+    }
+
+    size_t RateLimitMiddleware::size() const
+    {
+        size_t count = 0;
+        for (const Shard& shard : shards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            count += shard.buckets.size();
+        }
+        return count;
+    }
+}
@@ -0,0 +1,326 @@
+#include "middleware/ResponseCacheMiddleware.h"
+
+#include <algorithm>
+#include <charconv>
+#include <functional>
+
+namespace tinyHttp
+{
+    namespace
+    {
+        // Cache-Control中与缓存相关的指令
+        struct CacheControl
+        {
+            bool noStore = false;
+            bool noCache = false;
+            bool isPrivate = false;
+            long maxAge = -1;  // s-maxage优先于max-age，-1表示未声明
+        };
+
+        std::string_view trim(std::string_view s)
+        {
+            while (!s.empty() && (s.front() == ' ' || s.front() == '\t'))
+            {
+                s.remove_prefix(1);
+            }
+            while (!s.empty() && (s.back() == ' ' || s.back() == '\t'))
+            {
+                s.remove_suffix(1);
+            }
+            return s;
+        }
+
+        CacheControl parseCacheControl(std::string_view value)
+        {
+            CacheControl cc;
+            long maxAge = -1;
+            long sharedMaxAge = -1;
+            while (!value.empty())
+            {
+                const size_t comma = value.find(',');
+                const std::string_view directive = trim(value.substr(0, comma));
+                value = comma == std::string_view::npos ? std::string_view() : value.substr(comma + 1);
+
+                const size_t equal = directive.find('=');
+                const std::string_view name = trim(directive.substr(0, equal));
+                std::string_view argument = equal == std::string_view::npos ? std::string_view() : trim(directive.substr(equal + 1));
+                if (argument.size() >= 2 && argument.front() == '"' && argument.back() == '"')
+                {
+                    argument = argument.substr(1, argument.size() - 2);
+                }
+                long seconds = -1;
+                if (!argument.empty())
+                {
+                    std::from_chars(argument.data(), argument.data() + argument.size(), seconds);
+                }
+
+                if (HttpHeaders::equalsIgnoreCase(name, "no-store"))
+                {
+                    cc.noStore = true;
+                }
+                else if (HttpHeaders::equalsIgnoreCase(name, "no-cache"))
+                {
+                    cc.noCache = true;
+                }
+                else if (HttpHeaders::equalsIgnoreCase(name, "private"))
+                {
+                    cc.isPrivate = true;
+                }
+                else if (HttpHeaders::equalsIgnoreCase(name, "max-age"))
+                {
+                    maxAge = seconds;
+                }
+                else if (HttpHeaders::equalsIgnoreCase(name, "s-maxage"))
+                {
+                    sharedMaxAge = seconds;
+                }
+            }
+            cc.maxAge = sharedMaxAge >= 0 ? sharedMaxAge : maxAge;
+            return cc;
+        }
+
+        // 缓存键中路径所在的位置：方法与版本之后，'?'之前
+        std::string_view keyPath(std::string_view key)
+        {
+            const size_t begin = key.find(' ', key.find(' ') + 1) + 1;
+            return key.substr(begin, key.find('?', begin) - begin);
+        }
+    }
+
+    ResponseCacheMiddleware::ResponseCacheMiddleware(double defaultTtl, size_t maxBytes, size_t maxEntrySize)
+        : defaultTtl_(defaultTtl)
+        , maxStripeBytes_(maxBytes / kStripes)
+        , maxEntrySize_(std::min(maxEntrySize, maxBytes / kStripes))
+        , varyHeaders_{"Accept-Encoding"}
+    {
+
+    }
+
+    bool ResponseCacheMiddleware::isVaryHeader(std::string_view name) const
+    {
+        return std::any_of(varyHeaders_.begin(), varyHeaders_.end(), [name](const std::string& vary) {
+            return HttpHeaders::equalsIgnoreCase(vary, name);
+        });
+    }
+
+    bool ResponseCacheMiddleware::makeKey(const HttpRequest& request, std::string* key) const
+    {
+        if ((request.method() != HttpRequest::kGet && request.method() != HttpRequest::kHead) ||
+            !request.getHeader("Authorization").empty())
+        {
+            return false;
+        }
+        // 会话Cookie标识的是具体用户，除非Cookie参与缓存键或显式允许，否则不缓存
+        if (!cacheCookieRequests_ && !request.getHeader(HeaderId::kCookie).empty() && !isVaryHeader("Cookie"))
+        {
+            return false;
+        }
+
+        // 方法 版本 路径?排序后的查询参数
+        const std::string_view path = request.path();
+        key->reserve(64 + path.size());
+        key->append(HttpRequest::methodString(request.method()));
+        key->push_back(' ');
+        key->append(request.getVersion());
+        key->push_back(' ');
+        key->append(path);
+        key->push_back('?');
+
+        // 不同参数之间的顺序不影响语义，按参数名排序后参与缓存键；同名参数保持原有顺序，
+        // 处理函数取的是最后一次出现的值
+        std::vector<std::pair<std::string_view, std::string_view>> query;
+        query.reserve(request.queryParameterCount());
+        for (size_t i = 0; i < request.queryParameterCount(); ++i)
+        {
+            query.push_back(request.queryParameter(i));
+        }
+        std::stable_sort(query.begin(), query.end(),
+                         [](const auto& a, const auto& b) { return a.first < b.first; });
+        for (size_t i = 0; i < query.size(); ++i)
+        {
+            if (i > 0)
+            {
+                key->push_back('&');
+            }
+            key->append(query[i].first);
+            key->push_back('=');
+            key->append(query[i].second);
+        }
+
+        for (const std::string& name : varyHeaders_)
+        {
+            key->push_back('\n');
+            key->append(name);
+            key->push_back(':');
+            if (HttpHeaders::idOf(name) == HeaderId::kAcceptEncoding)
+            {
+                // 只区分实际会得到的编码，避免Accept-Encoding写法不同导致缓存碎片化
+                key->append(request.acceptsEncoding("gzip") ? "gzip"
+                            : request.acceptsEncoding("deflate") ? "deflate" : "identity");
+            }
+            else
+            {
+                key->append(trim(request.getHeader(name)));
+            }
+        }
+        return true;
+    }
+
+    ResponseCacheMiddleware::Stripe& ResponseCacheMiddleware::stripeOf(std::string_view key)
+    {
+        return stripes_[std::hash<std::string_view>{}(key) % kStripes];
+    }
+
+    void ResponseCacheMiddleware::evict(Stripe& stripe, std::list<Entry>::iterator it)
+    {
+        stripe.bytes -= it->bytes->size();
+        stripe.index.erase(it->key);
+        stripe.lru.erase(it);
+    }
+
+    bool ResponseCacheMiddleware::before(HttpRequest& request, HttpResponse& response)
+    {
+        std::string key;
+        if (!makeKey(request, &key))
+        {
+            return true;
+        }
+        // 客户端要求重新验证时不使用缓存，新的响应仍会更新缓存
+        const CacheControl requested = parseCacheControl(request.getHeader(HeaderId::kCacheControl));
+        if (requested.noCache || requested.noStore)
+        {
+            return true;
+        }
+
+        Stripe& stripe = stripeOf(key);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.index.find(key);
+        if (it == stripe.index.end())
+        {
+            return true;
+        }
+        const auto entry = it->second;
+        if (entry->expires < muduo::Timestamp::now())
+        {
+            evict(stripe, entry);
+            return true;
+        }
+        stripe.lru.splice(stripe.lru.begin(), stripe.lru, entry);
+        response.setStatusCode(entry->status);
+        response.setSerialized(entry->bytes, entry->connectionOffset);
+        return false;
+    }
+
+    void ResponseCacheMiddleware::after(const HttpRequest& request, HttpResponse& response)
+    {
+        if (response.getStatusCode() != HttpResponse::k200Ok || response.isSerialized() || response.isFile() ||
+            !response.getHeader(HeaderId::kSetCookie).empty())
+        {
+            return;
+        }
+        const CacheControl requested = parseCacheControl(request.getHeader(HeaderId::kCacheControl));
+        const CacheControl cc = parseCacheControl(response.getHeader(HeaderId::kCacheControl));
+        if (requested.noStore || cc.noStore || cc.noCache || cc.isPrivate || cc.maxAge == 0)
+        {
+            return;
+        }
+        // 响应按某个请求头区分而该请求头不在缓存键中时，缓存项会被其他取值的请求命中
+        std::string_view vary = response.getHeader("Vary");
+        while (!vary.empty())
+        {
+            const size_t comma = vary.find(',');
+            const std::string_view name = trim(vary.substr(0, comma));
+            vary = comma == std::string_view::npos ? std::string_view() : vary.substr(comma + 1);
+            if (name == "*" || (!name.empty() && !isVaryHeader(name)))
+            {
+                return;
+            }
+        }
+        std::string key;
+        if (!makeKey(request, &key))
+        {
+            return;
+        }
+
+        // 缓存的字节需要自带Content-Length，服务器在中间件之后才会补上
+        if (!response.headers().has(HeaderId::kContentLength) && !response.hasRawHeaders())
+        {
+            response.setContentLength(response.body().size());
+        }
+        if (response.serializedSize() > maxEntrySize_)
+        {
+            return;
+        }
+
+        Entry entry;
+        entry.bytes = std::make_shared<const std::string>(response.serialize(&entry.connectionOffset));
+        entry.status = response.getStatusCode();
+        entry.expires = muduo::addTime(muduo::Timestamp::now(), cc.maxAge > 0 ? static_cast<double>(cc.maxAge) : defaultTtl_);
+        entry.key = std::move(key);
+
+        Stripe& stripe = stripeOf(entry.key);
+        std::lock_guard<std::mutex> lock(stripe.mutex);
+        auto it = stripe.index.find(entry.key);
+        if (it != stripe.index.end())
+        {
+            evict(stripe, it->second);
+        }
+        stripe.bytes += entry.bytes->size();
+        stripe.lru.push_front(std::move(entry));
+        stripe.index.emplace(stripe.lru.front().key, stripe.lru.begin());
+        while (stripe.bytes > maxStripeBytes_ && stripe.lru.size() > 1)
+        {
+            evict(stripe, std::prev(stripe.lru.end()));
+        }
+    }
+
+    void ResponseCacheMiddleware::invalidate(std::string_view path)
+    {
+        for (Stripe& stripe : stripes_)
+        {
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            for (auto it = stripe.lru.begin(); it != stripe.lru.end();)
+            {
+                auto next = std::next(it);
+                if (keyPath(it->key) == path)
+                {
+                    evict(stripe, it);
+                }
+                it = next;
+            }
+        }
+    }
+
+    void ResponseCacheMiddleware::clear()
+    {
+        for (Stripe& stripe : stripes_)
+        {
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            stripe.index.clear();
+            stripe.lru.clear();
+            stripe.bytes = 0;
+        }
+    }
+
+    size_t ResponseCacheMiddleware::size() const
+    {
+        size_t count = 0;
+        for (const Stripe& stripe : stripes_)
+        {
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            count += stripe.lru.size();
+        }
+        return count;
+    }
+
+    size_t ResponseCacheMiddleware::bytes() const
+    {
+        size_t total = 0;
+        for (const Stripe& stripe : stripes_)
+        {
+            std::lock_guard<std::mutex> lock(stripe.mutex);
+            total += stripe.bytes;
+        }
+        return total;
+    }
+}
@@ -0,0 +1,305 @@
+#include "router/RouteMetrics.h"
+
+#include <cinttypes>
+#include <cstdio>
+#include <thread>
+
+namespace tinyHttp
+{
+    namespace
+    {
+        std::atomic<uint64_t> gNextMetricsId{1};
+
+        // 只有所属线程写入，读-改-写不需要加锁前缀的原子指令
+        inline void bump(std::atomic<uint64_t>& counter, uint64_t delta)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+        }
+
+        // Prometheus直方图导出的桶边界（微秒），HDR桶的上界不大于边界时计入该桶
+        constexpr uint64_t kExportBounds[] = {
+            100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000,
+            100000, 250000, 500000, 1000000, 2500000, 5000000, 10000000,
+        };
+
+        void appendLabelValue(std::string* out, std::string_view value)
+        {
+            for (char c : value)
+            {
+                if (c == '\\' || c == '"')
+                {
+                    out->push_back('\\');
+                    out->push_back(c);
+                }
+                else if (c == '\n')
+                {
+                    out->append("\\n");
+                }
+                else
+                {
+                    out->push_back(c);
+                }
+            }
+        }
+
+        void appendLabels(std::string* out, const RouteMetrics::RouteStats& stats)
+        {
+            out->append("{method=\"");
+            out->append(HttpRequest::methodString(stats.method));
+            out->append("\",route=\"");
+            appendLabelValue(out, stats.route);
+            out->push_back('"');
+        }
+
+        void appendNumber(std::string* out, uint64_t value)
+        {
+            char buf[24];
+            const int n = snprintf(buf, sizeof buf, "%" PRIu64, value);
+            out->append(buf, n);
+        }
+
+        void appendSeconds(std::string* out, uint64_t micros)
+        {
+            char buf[32];
+            const int n = snprintf(buf, sizeof buf, "%" PRIu64 ".%06" PRIu64, micros / 1000000, micros % 1000000);
+            out->append(buf, n);
+        }
+    }
+
+    uint64_t RouteMetrics::RouteStats::percentile(double q) const
+    {
+        if (count == 0)
+        {
+            return 0;
+        }
+        uint64_t target = static_cast<uint64_t>(q * static_cast<double>(count) + 0.999999);
+        target = target == 0 ? 1 : target;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBucketCount; ++i)
+        {
+            seen += buckets[i];
+            if (seen >= target)
+            {
+                return bucketUpperBound(i);
+            }
+        }
+        return bucketUpperBound(kBucketCount - 1);
+    }
+
+    RouteMetrics::Shard::Shard()
+    {
+        for (auto& chunk : chunks)
+        {
+            chunk.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+
+    RouteMetrics::Shard::~Shard()
+    {
+        for (auto& chunk : chunks)
+        {
+            delete chunk.load(std::memory_order_relaxed);
+        }
+    }
+
+    RouteMetrics::RouteMetrics()
+        : id_(gNextMetricsId.fetch_add(1, std::memory_order_relaxed))
+    {
+        // 编号0~kOptions留给各请求方法下未命中的请求
+        for (int method = HttpRequest::kInvalid; method <= HttpRequest::kOptions; ++method)
+        {
+            names_.push_back(RouteName{static_cast<HttpRequest::Method>(method), std::string()});
+        }
+    }
+
+    RouteMetrics::~RouteMetrics() = default;
+
+    int RouteMetrics::metricId(HttpRequest::Method method, const std::string& route)
+    {
+        std::string key(HttpRequest::methodString(method));
+        key.push_back(' ');
+        key.append(route);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = ids_.find(key);
+        if (it != ids_.end())
+        {
+            return it->second;
+        }
+        if (names_.size() >= kChunkRoutes * kMaxChunks)
+        {
+            return kNoMetric;
+        }
+        const int id = static_cast<int>(names_.size());
+        names_.push_back(RouteName{method, route});
+        ids_.emplace(std::move(key), id);
+        return id;
+    }
+
+    RouteMetrics::Shard* RouteMetrics::localShard()
+    {
+        // 线程缓存最近使用的分片，同一线程交替使用多个RouteMetrics时回退到加锁查找
+        struct Cache
+        {
+            uint64_t owner = 0;
+            Shard*   shard = nullptr;
+        };
+        thread_local Cache cache;
+        if (cache.owner == id_)
+        {
+            return cache.shard;
+        }
+
+        const std::thread::id self = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = threadShards_.find(self);
+        if (it == threadShards_.end())
+        {
+            // 线程退出后分片保留，统计不丢失；线程id被复用时由新线程接着写入
+            it = threadShards_.emplace(self, std::make_unique<Shard>()).first;
+        }
+        cache.owner = id_;
+        cache.shard = it->second.get();
+        return cache.shard;
+    }
+
+    void RouteMetrics::record(int id, uint64_t micros)
+    {
+        if (id < 0 || static_cast<size_t>(id) >= kChunkRoutes * kMaxChunks)
+        {
+            return;
+        }
+        Shard* shard = localShard();
+        std::atomic<Chunk*>& slot = shard->chunks[id / kChunkRoutes];
+        Chunk* chunk = slot.load(std::memory_order_relaxed);
+        if (!chunk)
+        {
+            chunk = new Chunk();
+            slot.store(chunk, std::memory_order_release);
+        }
+        Counters& counters = chunk->routes[id % kChunkRoutes];
+        bump(counters.count, 1);
+        bump(counters.sumMicros, micros);
+        bump(counters.buckets[bucketIndex(micros)], 1);
+    }
+
+    std::vector<RouteMetrics::RouteStats> RouteMetrics::snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<RouteStats> result;
+        for (size_t id = 0; id < names_.size(); ++id)
+        {
+            RouteStats stats;
+            stats.method = names_[id].method;
+            stats.route = names_[id].route;
+            for (const auto& item : threadShards_)
+            {
+                const Chunk* chunk = item.second->chunks[id / kChunkRoutes].load(std::memory_order_acquire);
+                if (!chunk)
+                {
+                    continue;
+                }
+                const Counters& counters = chunk->routes[id % kChunkRoutes];
+                stats.count += counters.count.load(std::memory_order_relaxed);
+                stats.sumMicros += counters.sumMicros.load(std::memory_order_relaxed);
+                for (size_t i = 0; i < kBucketCount; ++i)
+                {
+                    stats.buckets[i] += counters.buckets[i].load(std::memory_order_relaxed);
+                }
+            }
+            if (stats.count > 0)
+            {
+                result.push_back(std::move(stats));
+            }
+        }
+        return result;
+    }
+
+    std::string RouteMetrics::renderPrometheus() const
+    {
+        const std::vector<RouteStats> routes = snapshot();
+        std::string out;
+        out.reserve(256 + routes.size() * 2048);
+
+        out.append("# HELP tinyhttp_route_requests_total Requests dispatched per route.\n"
+                   "# TYPE tinyhttp_route_requests_total counter\n");
+        for (const RouteStats& stats : routes)
+        {
+            out.append("tinyhttp_route_requests_total");
+            appendLabels(&out, stats);
+            out.append("} ");
+            appendNumber(&out, stats.count);
+            out.push_back('\n');
+        }
+
+        // 各分片在读取过程中仍可能写入，count取桶的合计以保证+Inf桶与count一致
+        out.append("# HELP tinyhttp_route_latency_seconds Handler latency per route.\n"
+                   "# TYPE tinyhttp_route_latency_seconds histogram\n");
+        for (const RouteStats& stats : routes)
+        {
+            uint64_t cumulative = 0;
+            size_t bucket = 0;
+            for (uint64_t bound : kExportBounds)
+            {
+                for (; bucket < kBucketCount && bucketUpperBound(bucket) <= bound; ++bucket)
+                {
+                    cumulative += stats.buckets[bucket];
+                }
+                out.append("tinyhttp_route_latency_seconds_bucket");
+                appendLabels(&out, stats);
+                out.append(",le=\"");
+                appendSeconds(&out, bound);
+                out.append("\"} ");
+                appendNumber(&out, cumulative);
+                out.push_back('\n');
+            }
+            for (; bucket < kBucketCount; ++bucket)
+            {
+                cumulative += stats.buckets[bucket];
+            }
+            out.append("tinyhttp_route_latency_seconds_bucket");
+            appendLabels(&out, stats);
+            out.append(",le=\"+Inf\"} ");
+            appendNumber(&out, cumulative);
+            out.push_back('\n');
+
+            out.append("tinyhttp_route_latency_seconds_sum");
+            appendLabels(&out, stats);
+            out.append("} ");
+            appendSeconds(&out, stats.sumMicros);
+            out.push_back('\n');
+
+            out.append("tinyhttp_route_latency_seconds_count");
+            appendLabels(&out, stats);
+            out.append("} ");
+            appendNumber(&out, cumulative);
+            out.push_back('\n');
+        }
+        return out;
+    }
+
+    size_t RouteMetrics::bucketIndex(uint64_t micros)
+    {
+        if (micros < kExactBuckets)
+        {
+            return static_cast<size_t>(micros);
+        }
+        const uint64_t maxValue = (uint64_t(1) << kMaxExponent) - 1;
+        micros = micros > maxValue ? maxValue : micros;
+        const size_t exponent = 63 - static_cast<size_t>(__builtin_clzll(micros));
+        const size_t sub = static_cast<size_t>(micros >> (exponent - kSubBucketBits)) & ((1u << kSubBucketBits) - 1);
+        return kExactBuckets + ((exponent - 4) << kSubBucketBits) + sub;
+    }
+
+    uint64_t RouteMetrics::bucketUpperBound(size_t index)
+    {
+        if (index < kExactBuckets)
+        {
+            return index;
+        }
+        const size_t exponent = 4 + ((index - kExactBuckets) >> kSubBucketBits);
+        const size_t sub = (index - kExactBuckets) & ((1u << kSubBucketBits) - 1);
+        const uint64_t width = uint64_t(1) << (exponent - kSubBucketBits);
+        return ((uint64_t(1) << kSubBucketBits) + sub) * width + width - 1;
+    }
+}
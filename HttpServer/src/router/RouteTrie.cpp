@@ -0,0 +1,174 @@
+#include "router/RouteTrie.h"
+
+#include <algorithm>
+
+#include <muduo/base/Logging.h>
+
+namespace tinyHttp
+{
+    struct RouteTrie::Node
+    {
+        Node()
+        {
+            routes.fill(kNoRoute);
+        }
+
+        // 普通段子节点，按段内容有序排列，查找时二分
+        std::vector<std::pair<std::string, NodePtr>> statics;
+        NodePtr                                      param;    // ":name"段
+        NodePtr                                      wildcard; // "*name"段，总是叶子
+        std::array<int, kMethodCount>                routes;   // 各请求方法在该节点结束的路由编号
+
+        Node* staticChild(std::string_view segment) const
+        {
+            auto it = std::lower_bound(statics.begin(), statics.end(), segment,
+                                       [](const auto& child, std::string_view s) { return child.first < s; });
+            return it != statics.end() && it->first == segment ? it->second.get() : nullptr;
+        }
+
+        Node* addStaticChild(std::string_view segment)
+        {
+            auto it = std::lower_bound(statics.begin(), statics.end(), segment,
+                                       [](const auto& child, std::string_view s) { return child.first < s; });
+            if (it == statics.end() || it->first != segment)
+            {
+                it = statics.emplace(it, std::string(segment), std::make_unique<Node>());
+            }
+            return it->second.get();
+        }
+
+        bool empty() const
+        {
+            return statics.empty() && !param && !wildcard &&
+                   std::all_of(routes.begin(), routes.end(), [](int r) { return r == kNoRoute; });
+        }
+    };
+
+    RouteTrie::RouteTrie()
+        : root_(std::make_unique<Node>())
+    {
+
+    }
+
+    RouteTrie::~RouteTrie() = default;
+    RouteTrie::RouteTrie(RouteTrie&&) noexcept = default;
+    RouteTrie& RouteTrie::operator=(RouteTrie&&) noexcept = default;
+
+    bool RouteTrie::insert(HttpRequest::Method method, std::string_view pattern, int route,
+                           std::vector<std::string>* paramNames)
+    {
+        if (pattern.empty() || pattern.front() != '/' || method == HttpRequest::kInvalid)
+        {
+            LOG_ERROR << "Invalid route pattern: " << std::string(pattern);
+            return false;
+        }
+
+        paramNames->clear();
+        Node* node = root_.get();
+        size_t pos = 1;
+        while (true)
+        {
+            const size_t end = pattern.find('/', pos);
+            const std::string_view segment = pattern.substr(pos, end == std::string_view::npos ? end : end - pos);
+            const bool last = end == std::string_view::npos;
+
+            if (!segment.empty() && (segment.front() == ':' || segment.front() == '*'))
+            {
+                if (segment.size() == 1 && segment.front() == ':')
+                {
+                    LOG_ERROR << "Unnamed parameter in route pattern: " << std::string(pattern);
+                    return false;
+                }
+                if (segment.front() == '*' && !last)
+                {
+                    LOG_ERROR << "Wildcard must be the last segment: " << std::string(pattern);
+                    return false;
+                }
+                if (paramNames->size() == kMaxParams)
+                {
+                    LOG_ERROR << "Too many parameters in route pattern: " << std::string(pattern);
+                    return false;
+                }
+                // 未命名的通配段以"*"作为参数名
+                paramNames->emplace_back(segment.size() == 1 ? segment : segment.substr(1));
+                NodePtr& child = segment.front() == ':' ? node->param : node->wildcard;
+                if (!child)
+                {
+                    child = std::make_unique<Node>();
+                }
+                node = child.get();
+            }
+            else
+            {
+                node = node->addStaticChild(segment);
+            }
+
+            if (last)
+            {
+                break;
+            }
+            pos = end + 1;
+        }
+        node->routes[static_cast<size_t>(method)] = route;
+        return true;
+    }
+
+    bool RouteTrie::match(HttpRequest::Method method, std::string_view path, Match* match) const
+    {
+        match->count = 0;
+        match->route = kNoRoute;
+        if (path.empty() || path.front() != '/' || static_cast<size_t>(method) >= kMethodCount)
+        {
+            return false;
+        }
+        match->route = matchNode(root_.get(), method, path, 1, match);
+        return match->route != kNoRoute;
+    }
+
+    int RouteTrie::matchNode(const Node* node, HttpRequest::Method method,
+                             std::string_view path, size_t pos, Match* match)
+    {
+        if (pos == std::string_view::npos)
+        {
+            return node->routes[static_cast<size_t>(method)];
+        }
+
+        const size_t end = path.find('/', pos);
+        const std::string_view segment = path.substr(pos, end == std::string_view::npos ? end : end - pos);
+        const size_t next = end == std::string_view::npos ? end : end + 1;
+
+        if (const Node* child = node->staticChild(segment))
+        {
+            const int route = matchNode(child, method, path, next, match);
+            if (route != kNoRoute)
+            {
+                return route;
+            }
+        }
+
+        if (node->param && !segment.empty())
+        {
+            const size_t count = match->count;
+            match->captures[count] = Capture{static_cast<uint32_t>(pos), static_cast<uint32_t>(segment.size())};
+            match->count = count + 1;
+            const int route = matchNode(node->param.get(), method, path, next, match);
+            if (route != kNoRoute)
+            {
+                return route;
+            }
+            match->count = count; // 回溯
+        }
+
+        if (node->wildcard && node->wildcard->routes[static_cast<size_t>(method)] != kNoRoute)
+        {
+            match->captures[match->count++] = Capture{static_cast<uint32_t>(pos), static_cast<uint32_t>(path.size() - pos)};
+            return node->wildcard->routes[static_cast<size_t>(method)];
+        }
+        return kNoRoute;
+    }
+
+    bool RouteTrie::empty() const
+    {
+        return root_->empty();
+    }
+}
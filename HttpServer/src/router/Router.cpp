@@ -1,84 +1,269 @@
 #include "../../include/router/Router.h"
+#include "../../include/router/PerfectHashMap.h"
+#include <chrono>
+
 #include <muduo/base/Logging.h>
 
 namespace tinyHttp
 {
-    // 注册静态路由处理器
-    void Router::registerHandler(HttpRequest::Method method, const std::string &path, HandlerPtr handler)
+    namespace
+    {
+        // 路由表版本号在所有Router间全局递增，线程缓存只需比较版本号即可判断是否为同一张路由表
+        std::atomic<uint64_t> gNextTableVersion{1};
+
+        // 每个线程缓存路由表的Router数量
+        constexpr size_t kThreadCacheSlots = 4;
+
+        // 调用处理器并记录耗时，metrics为空时不计时
+        template <typename Handle>
+        void invoke(RouteMetrics *metrics, int id, Handle &&handle)
+        {
+            if (!metrics)
+            {
+                handle();
+                return;
+            }
+            const auto start = std::chrono::steady_clock::now();
+            handle();
+            const auto elapsed = std::chrono::steady_clock::now() - start;
+            metrics->record(id, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()));
+        }
+    }
+
+    // 编译后的路由表，构建完成后只读，可被多个IO线程同时访问
+    // 所有路由的处理函数连续存放在entries中，静态路由的完美哈希表与动态路由的前缀树都只保存下标
+    struct Router::RouteTable
+    {
+        struct Entry
+        {
+            InlineHandler            handler;
+            std::vector<std::string> paramNames; // 动态路由按出现顺序排列的参数名，静态路由为空
+            int                      metric = RouteMetrics::kNoMetric;
+        };
+
+        struct StreamingRoute
+        {
+            StreamingHandler handler;
+            int              entry; // onComplete对应的下标
+        };
+
+        int add(InlineHandler handler, std::vector<std::string> paramNames, int metric)
+        {
+            entries.push_back(Entry{std::move(handler), std::move(paramNames), metric});
+            return static_cast<int>(entries.size() - 1);
+        }
+
+        uint64_t                       version = 0;
+        RouteMetrics                  *metrics = nullptr; // 关闭统计时为空
+        std::vector<Entry>             entries;
+        PerfectHashMap<int>            statics;
+        PerfectHashMap<StreamingRoute> streaming;
+        RouteTrie                      trie;   // 动态路由前缀树
+    };
+
+    // 注册静态路由
+    void Router::registerRoute(HttpRequest::Method method, const std::string &path, InlineHandler handler)
     {
         // key由请求方法和路径组成
         RouteKey key{method, path};
-        handlers_[key] = std::move(handler);
+        std::lock_guard<std::mutex> lock(mutex_);
+        routes_[key] = std::move(handler);
     }
 
-    void Router::registerCallback(HttpRequest::Method method, const std::string &path, const HandlerCallback &callback)
+    void Router::registerStreamingHandler(HttpRequest::Method method, const std::string &path, StreamingHandler handler)
     {
         RouteKey key{method, path};
-        callbacks_[key] = std::move(callback);
+        std::lock_guard<std::mutex> lock(mutex_);
+        streamingHandlers_[key] = std::move(handler);
+    }
+
+    const Router::StreamingHandler *Router::findStreamingHandler(const HttpRequest &req) const
+    {
+        const RouteTable &table = *this->table();
+        if (table.streaming.empty())
+        {
+            return nullptr;
+        }
+        const RouteTable::StreamingRoute *route = table.streaming.find(req.method(), req.path());
+        return route ? &route->handler : nullptr;
+    }
+
+    void Router::addDynamicRoute(HttpRequest::Method method, const std::string &path, InlineHandler handler)
+    {
+        // 注册时即校验模式，格式错误的路由不进入注册信息
+        RouteTrie probe;
+        std::vector<std::string> paramNames;
+        if (!probe.insert(method, path, 0, &paramNames))
+        {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        dynamicRoutes_.push_back(DynamicRoute{method, path, std::move(handler)});
+    }
+
+    void Router::registerMetricsEndpoint(const std::string &path)
+    {
+        registerCallback(HttpRequest::kGet, path, [this](const HttpRequest &, HttpResponse *resp) {
+            resp->setStatusCode(HttpResponse::k200Ok);
+            resp->setContentType("text/plain; version=0.0.4; charset=utf-8");
+            resp->setBody(metrics_.renderPrometheus());
+        });
+    }
+
+    void Router::clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        routes_.clear();
+        dynamicRoutes_.clear();
+        streamingHandlers_.clear();
+    }
+
+    void Router::compile()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        publish(build());
     }
 
-    bool Router::route(const HttpRequest &req, HttpResponse *resp)
+    std::shared_ptr<const Router::RouteTable> Router::build() const
     {
-        RouteKey key{req.method(), req.path()};
+        auto table = std::make_shared<RouteTable>();
+        table->metrics = metricsEnabled_ ? &metrics_ : nullptr;
+
+        table->entries.reserve(routes_.size() + streamingHandlers_.size() + dynamicRoutes_.size());
 
-        // 先在注册的静态路由中查找
-        // 查找处理器
-        auto handlerIt = handlers_.find(key);
-        if (handlerIt != handlers_.end())
+        std::vector<PerfectHashMap<int>::Entry> staticEntries;
+        staticEntries.reserve(routes_.size());
+        for (const auto &item : routes_)
         {
-            // 找到处理器则执行
-            handlerIt->second->handle(req, resp);
-            return true;
+            const int entry = table->add(item.second, {}, metrics_.metricId(item.first.method, item.first.path));
+            staticEntries.push_back({item.first.method, item.first.path, entry});
         }
+        table->statics = PerfectHashMap<int>(std::move(staticEntries));
 
-        // 查找回调函数
-        auto callbackIt = callbacks_.find(key);
-        if (callbackIt != callbacks_.end())
+        std::vector<PerfectHashMap<RouteTable::StreamingRoute>::Entry> streamingEntries;
+        streamingEntries.reserve(streamingHandlers_.size());
+        for (const auto &item : streamingHandlers_)
         {
-            callbackIt->second(req, resp);
-            return true;
+            const int entry = table->add(item.second.onComplete, {},
+                                         metrics_.metricId(item.first.method, item.first.path));
+            streamingEntries.push_back({item.first.method, item.first.path, {item.second, entry}});
         }
+        table->streaming = PerfectHashMap<RouteTable::StreamingRoute>(std::move(streamingEntries));
 
-        // 查找动态路由处理器 使用之前注册的正则表达式进行匹配
-        /*
-         * 注册动态路由时，路径会被转换为正则表达式进行匹配
-         * 动态路由使查询url相应的回调时，即使url中带有路径参数(user/:123)也能正确匹配到对应的回调
-         */
-        for (const auto &[method, pathRegex, handler] : regexHandlers_)
-        {
-            std::smatch match;
-            // 待匹配字符串
-            std::string pathStr(req.path());
-            // 如果方法匹配并且动态路由匹配，则执行处理器
-            // match用于存储正则表达式匹配结果，返回一个结果数组
-            if (method == req.method() && std::regex_match(pathStr, match, pathRegex))
+        // 按注册顺序插入，同一方法与模式重复注册时后者覆盖前者
+        for (const DynamicRoute &route : dynamicRoutes_)
+        {
+            std::vector<std::string> paramNames;
+            const int entry = static_cast<int>(table->entries.size());
+            if (table->trie.insert(route.method_, route.pattern_, entry, &paramNames))
             {
-                // 复制构造一个新的请求对象以便修改
-                HttpRequest newReq(req);
-                extractPathParameters(match, newReq);
+                table->add(route.handler_, std::move(paramNames), metrics_.metricId(route.method_, route.pattern_));
+            }
+        }
+
+        table->version = gNextTableVersion.fetch_add(1, std::memory_order_relaxed);
+        return table;
+    }
+
+    void Router::publish(std::shared_ptr<const RouteTable> table) const
+    {
+        const uint64_t version = table->version;
+        // 先发布路由表再发布版本号，读到新版本号的线程一定能加载到对应的路由表
+        std::atomic_store_explicit(&table_, std::move(table), std::memory_order_release);
+        version_.store(version, std::memory_order_release);
+    }
+
+    const std::shared_ptr<const Router::RouteTable> &Router::table() const
+    {
+        // 每个线程为最近使用的几个Router各缓存一份路由表引用，多个Router交替查找时互不覆盖；
+        // 热替换后旧路由表在该线程下一次查找时才释放。版本号全局递增，
+        // Router销毁后复用同一地址的新Router不会命中旧缓存
+        struct Slot
+        {
+            const Router                     *router = nullptr;
+            uint64_t                          version = 0;
+            std::shared_ptr<const RouteTable> table;
+        };
+        thread_local Slot slots[kThreadCacheSlots];
+        thread_local size_t nextSlot = 0;
 
-                handler->handle(newReq, resp);
-                return true;
+        Slot *slot = nullptr;
+        for (Slot &candidate : slots)
+        {
+            if (candidate.router == this)
+            {
+                slot = &candidate;
+                break;
+            }
+        }
+        uint64_t version = version_.load(std::memory_order_acquire);
+        if (slot && version != 0 && version == slot->version)
+        {
+            return slot->table;
+        }
+        if (version == 0)
+        {
+            // 未显式编译，第一次查找时编译
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!std::atomic_load_explicit(&table_, std::memory_order_acquire))
+            {
+                publish(build());
             }
         }
+        if (!slot)
+        {
+            slot = &slots[nextSlot];
+            nextSlot = (nextSlot + 1) % kThreadCacheSlots;
+            slot->router = this;
+        }
+        slot->table = std::atomic_load_explicit(&table_, std::memory_order_acquire);
+        slot->version = slot->table->version;
+        return slot->table;
+    }
+
+    bool Router::route(HttpRequest &req, HttpResponse *resp)
+    {
+        // 持有一份引用直到处理器返回：处理器中嵌套调用其他Router可能替换线程缓存，
+        // 此时本Router的旧路由表若已被热替换，只由这里的引用保持存活
+        const std::shared_ptr<const RouteTable> current = this->table();
+        const RouteTable &table = *current;
 
-        // 查找动态路由回调函数
-        for (const auto &[method, pathRegex, callback] : regexCallbacks_)
+        // 先在静态路由中查找，完美哈希查找只需一次键比较，不构造std::string
+        int entry = RouteTrie::kNoRoute;
+        if (const int *index = table.statics.find(req.method(), req.path()))
         {
-            std::smatch match;
-            std::string pathStr(req.path());
-            // 如果方法匹配并且动态路由匹配，则执行回调函数
-            if (method == req.method() && std::regex_match(pathStr, match, pathRegex))
+            entry = *index;
+        }
+        else if (req.bodyStreamed())
+        {
+            // 请求体已流式交付的请求由对应处理器生成响应
+            if (const RouteTable::StreamingRoute *streaming = table.streaming.find(req.method(), req.path()))
             {
-                // Extract path parameters and add them to the request
-                HttpRequest newReq(req); // 因为这里需要用这一次所以是可以改的
-                extractPathParameters(match, newReq);
+                entry = streaming->entry;
+            }
+        }
 
-                callback(req, resp);
-                return true;
+        // 在前缀树中查找动态路由，耗时只与路径长度有关，与注册的路由数量无关
+        RouteTrie::Match match;
+        if (entry == RouteTrie::kNoRoute && table.trie.match(req.method(), req.path(), &match))
+        {
+            entry = match.route;
+            // 路径参数直接写入原请求，不复制请求对象
+            extractPathParameters(match, table.entries[entry].paramNames, req);
+        }
+
+        if (entry == RouteTrie::kNoRoute)
+        {
+            if (table.metrics)
+            {
+                table.metrics->record(table.metrics->unmatchedId(req.method()), 0);
             }
+            return false;
         }
 
-        return false;
+        const RouteTable::Entry &route = table.entries[entry];
+        invoke(table.metrics, route.metric, [&] { route.handler(req, resp); });
+        return true;
     }
-}
\ No newline at end of file
+}
@@ -1,4 +1,5 @@
 #include "../../include/session/Session.h"
+#include "../../include/session/SessionManager.h"
 
 #include <memory>
 #include <string>
@@ -7,8 +8,18 @@
 
 namespace tinyHttp
 {
+    namespace
+    {
+        int64_t nowMillis()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
     Session::Session(const std::string& sessionId, SessionManager* sessionManager, int maxAge)
     : sessionId_(sessionId)
+    , expiryTime_(0)
     , maxAge_(maxAge)
     , sessionManager_(sessionManager)
     {
@@ -18,13 +29,13 @@ namespace tinyHttp
     // 检查会话是否已过期
     bool Session::isExpired() const
     {
-        return std::chrono::system_clock::now() > expiryTime_;
+        return nowMillis() > expiryMillis();
     }
 
     // 刷新会话的过期时间
     void Session::refresh()
     {
-        expiryTime_ = std::chrono::system_clock::now() + std::chrono::seconds(maxAge_);
+        expiryTime_.store(nowMillis() + int64_t(maxAge_) * 1000, std::memory_order_relaxed);
     }
 
     // 设置会话数据
@@ -4,6 +4,8 @@
 
 #include "../../include/session/SessionManager.h"
 
+#include <sstream>
+
 
 namespace tinyHttp
 {
@@ -49,6 +51,7 @@ namespace tinyHttp
     {
         std::stringstream ss;
         std::uniform_int_distribution<> dist(0, 15);
+        std::lock_guard<std::mutex> lock(rngMutex_);
 
         // 生成32个字符的会话ID，每个字符是一个十六进制数字
         for (int i = 0; i < 32; ++i)
@@ -63,27 +66,31 @@ namespace tinyHttp
         storage_->remove(sessionId);
     }
 
-    void SessionManager::cleanExpiredSessions()
+    // 过期清理的方式依赖于具体的存储实现，内存存储推进其时间轮
+    size_t SessionManager::cleanExpiredSessions()
+    {
+        return storage_->removeExpired();
+    }
+
+    void SessionManager::startCleanup(muduo::net::EventLoop* loop, double interval)
     {
-        // 注意：这个实现依赖于具体的存储实现
-        // 对于内存存储，可以在加载时检查是否过期
-        // 对于其他存储的实现，可能需要定期清理过期会话
+        loop->runEvery(interval, [this] { cleanExpiredSessions(); });
     }
 
     // 从请求的Cookie头中提取会话ID
     std::string SessionManager::getSessionIdFromCookie(const HttpRequest& req)
     {
         std::string sessionId;
-        std::string cookie = req.getHeader("Cookie");
+        std::string_view cookie = req.getHeader("Cookie");
 
         if (!cookie.empty())
         {
             size_t pos = cookie.find("sessionId=");
-            if (pos != std::string::npos)
+            if (pos != std::string_view::npos)
             {
                 pos += 10; // 跳过"sessionId="
                 size_t end = cookie.find(';', pos);
-                if (end != std::string::npos)
+                if (end != std::string_view::npos)
                 {
                     sessionId = cookie.substr(pos, end - pos);
                 }
@@ -1,40 +1,172 @@
 #include "../../include/session/SessionStorage.h"
 
+#include <algorithm>
+#include <mutex>
+
 
 namespace tinyHttp
 {
+    namespace
+    {
+        int64_t nowMillis()
+        {
+            return std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+        }
+    }
+
+    MemorySessionStorage::MemorySessionStorage(std::chrono::milliseconds tick)
+        : tickMillis_(std::max<int64_t>(tick.count(), 1))
+    {
+        const int64_t now = nowMillis() / tickMillis_;
+        for (Shard& shard : shards_)
+        {
+            shard.wheel.resize(kWheelSlots);
+            shard.sweptTick = now;
+        }
+    }
+
+    void MemorySessionStorage::schedule(Shard& shard, const std::string& sessionId, Entry& entry)
+    {
+        // 过期时间所在刻度的下一个刻度一定晚于过期时间；已推进过的刻度不会再被访问，顺延到下一个刻度
+        entry.tick = std::max(entry.session->expiryMillis() / tickMillis_ + 1, shard.sweptTick + 1);
+        shard.wheel[entry.tick % kWheelSlots].push_back(sessionId);
+    }
+
     void MemorySessionStorage::save(std::shared_ptr<Session> session)
     {
-        // 创建会话副本并存储
-        sessions_[session->getId()] = session;
+        Shard& shard = shardOf(session->getId());
+        {
+            // 同一会话对象已在时间轮中，到期时会按最新的过期时间重新挂入，刷新后的保存无需写锁
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.sessions.find(session->getId());
+            if (it != shard.sessions.end() && it->second.session == session)
+            {
+                return;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        Entry& entry = shard.sessions[session->getId()];
+        const bool scheduled = entry.session != nullptr;
+        entry.session = std::move(session);
+        if (!scheduled)
+        {
+            schedule(shard, entry.session->getId(), entry);
+        }
     }
 
     // 通过会话ID从存储中加载会话
     std::shared_ptr<Session> MemorySessionStorage::load(const std::string& sessionId)
     {
-        auto it = sessions_.find(sessionId);
-        if (it != sessions_.end())
+        Shard& shard = shardOf(sessionId);
         {
-            if (!it->second->isExpired())
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.sessions.find(sessionId);
+            if (it == shard.sessions.end())
             {
-                return it->second;
+                return nullptr;
             }
-            else
+            if (!it->second.session->isExpired())
             {
-                // 如果会话已过期，则从存储中移除
-                sessions_.erase(it);
+                return it->second.session;
             }
         }
 
-        // 如果会话不存在或已过期，则返回nullptr
+        // 如果会话已过期，则从存储中移除，不必等到时间轮推进
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(sessionId);
+        if (it != shard.sessions.end() && it->second.session->isExpired())
+        {
+            shard.sessions.erase(it);
+        }
         return nullptr;
     }
 
-    // 通过会话ID从存储中移除会话
+    // 通过会话ID从存储中移除会话，时间轮中残留的id在到期时丢弃
     void MemorySessionStorage::remove(const std::string& sessionId)
     {
-        sessions_.erase(sessionId);
+        Shard& shard = shardOf(sessionId);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        shard.sessions.erase(sessionId);
+    }
+
+    size_t MemorySessionStorage::removeExpired()
+    {
+        return removeExpired(nowMillis());
     }
 
+    size_t MemorySessionStorage::removeExpired(int64_t nowMillis)
+    {
+        const int64_t target = nowMillis / tickMillis_;
+        size_t removed = 0;
+        std::vector<std::string> refreshed;
+        for (Shard& shard : shards_)
+        {
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            if (target <= shard.sweptTick)
+            {
+                continue;
+            }
+            // 落后超过一圈时每个槽只需访问一次
+            const int64_t first = std::max(shard.sweptTick + 1, target - static_cast<int64_t>(kWheelSlots) + 1);
+            refreshed.clear();
+            for (int64_t tick = first; tick <= target; ++tick)
+            {
+                std::vector<std::string>& slot = shard.wheel[tick % kWheelSlots];
+                size_t kept = 0;
+                for (size_t i = 0; i < slot.size(); ++i)
+                {
+                    std::string& id = slot[i];
+                    auto it = shard.sessions.find(id);
+                    if (it == shard.sessions.end())
+                    {
+                        continue; // 会话已被移除
+                    }
+                    if (it->second.tick > target)
+                    {
+                        // 属于之后几圈的刻度，留在槽中
+                        if (kept != i)
+                        {
+                            slot[kept] = std::move(id);
+                        }
+                        ++kept;
+                    }
+                    else if (it->second.session->expiryMillis() < nowMillis)
+                    {
+                        shard.sessions.erase(it);
+                        ++removed;
+                    }
+                    else
+                    {
+                        refreshed.push_back(std::move(id));
+                    }
+                }
+                slot.resize(kept);
+            }
+            shard.sweptTick = target;
+
+            // 到期前被刷新过的会话按新的过期时间重新挂入
+            for (const std::string& id : refreshed)
+            {
+                auto it = shard.sessions.find(id);
+                if (it != shard.sessions.end() && it->second.tick <= target)
+                {
+                    schedule(shard, it->first, it->second);
+                }
+            }
+        }
+        return removed;
+    }
 
-}
\ No newline at end of file
+    size_t MemorySessionStorage::size() const
+    {
+        size_t count = 0;
+        for (const Shard& shard : shards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            count += shard.sessions.size();
+        }
+        return count;
+    }
+}